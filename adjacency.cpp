@@ -0,0 +1,72 @@
+/*********************************************************************
+Hypersimplex Representer
+Copyright (C) 2017 Roman Gilg
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#include "adjacency.h"
+
+#include <algorithm>
+
+Edge::Edge(int _v, int _w)
+{
+    if (_v <= _w) {
+        v = _v;
+        w = _w;
+    } else {
+        v = _w;
+        w = _v;
+    }
+}
+
+Adjacency::Adjacency(std::vector<std::size_t> offsets, std::vector<int> neighbours)
+    : m_offsets(offsets),
+      m_neighbours(neighbours),
+      m_edgeIds(neighbours.size(), -1)
+{
+    const int count = vertexCount();
+    m_edges.reserve(m_neighbours.size() / 2);
+
+    // number the edges from their smaller vertex...
+    for (int v = 0; v < count; v++) {
+        for (std::size_t i = m_offsets[v]; i < m_offsets[v + 1]; i++) {
+            if (v < m_neighbours[i]) {
+                m_edgeIds[i] = m_edges.size();
+                m_edges.push_back(Edge(v, m_neighbours[i]));
+            }
+        }
+    }
+
+    // ...and look the ids up for the entries at their larger vertex
+    for (int v = 0; v < count; v++) {
+        for (std::size_t i = m_offsets[v]; i < m_offsets[v + 1]; i++) {
+            if (m_neighbours[i] < v) {
+                m_edgeIds[i] = edgeId(m_neighbours[i], v);
+            }
+        }
+    }
+}
+
+int Adjacency::edgeId(int v, int w) const
+{
+    const int *begin = neighboursBegin(v);
+    const int *end = neighboursEnd(v);
+    const int *it = std::lower_bound(begin, end, w);
+
+    if (it == end || *it != w) {
+        return -1;
+    }
+    return m_edgeIds[it - m_neighbours.data()];
+}
@@ -0,0 +1,83 @@
+/*********************************************************************
+Hypersimplex Representer
+Copyright (C) 2017 Roman Gilg
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#ifndef ADJACENCY_H
+#define ADJACENCY_H
+
+#include <cstddef>
+#include <vector>
+
+struct Edge {
+    Edge(int _v, int _w);
+    inline bool operator==(Edge const& b) const { return v == b.v && w == b.w; }
+    inline bool operator!=(Edge const& b) const { return !(*this == b); }
+    inline bool operator<(Edge const& b) const { return v < b.v || (v == b.v && w < b.w); }
+    inline bool has(int vertex) const { return v == vertex || w == vertex; }
+    int v, w;
+};
+
+/*
+ * Vertex adjacency in compressed sparse row format.
+ *
+ * The neighbours of every vertex are sorted ascending. Edges are numbered
+ * in lexicographic order of their (smaller, larger) vertex pair and every
+ * neighbour entry also stores the id of the connecting edge.
+ */
+class Adjacency {
+public:
+    Adjacency() {}
+    Adjacency(std::vector<std::size_t> offsets, std::vector<int> neighbours);
+
+    int vertexCount() const {
+        return m_offsets.empty() ? 0 : m_offsets.size() - 1;
+    }
+    int edgeCount() const {
+        return m_edges.size();
+    }
+
+    int degree(int vertex) const {
+        return m_offsets[vertex + 1] - m_offsets[vertex];
+    }
+    const int *neighboursBegin(int vertex) const {
+        return m_neighbours.data() + m_offsets[vertex];
+    }
+    const int *neighboursEnd(int vertex) const {
+        return m_neighbours.data() + m_offsets[vertex + 1];
+    }
+    const int *edgeIdsBegin(int vertex) const {
+        return m_edgeIds.data() + m_offsets[vertex];
+    }
+
+    // returns -1 if there is no edge between v and w
+    int edgeId(int v, int w) const;
+
+    const Edge &edge(int id) const {
+        return m_edges[id];
+    }
+    const std::vector<Edge> &edges() const {
+        return m_edges;
+    }
+
+private:
+    std::vector<std::size_t> m_offsets;
+    std::vector<int> m_neighbours;
+    std::vector<int> m_edgeIds;
+    std::vector<Edge> m_edges;
+};
+
+#endif // ADJACENCY_H
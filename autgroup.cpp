@@ -17,52 +17,55 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *********************************************************************/
 
 #include "autgroup.h"
+#include "trace.h"
 
-#include <algorithm>
-
-#include <stdio.h>
-#include <unistd.h>
+#include <cctype>
 
 #include <QDebug>
 
-static int factorial(int n)
-{
-  return (n == 1 || n == 0) ? 1 : factorial(n - 1) * n;
-}
-
-std::string AutGroup::gap_eval(const std::string _cmd, bool readOutput, std::string end) const
-{
-    const char *cmd = _cmd.c_str();
-    std::string ret;
-    const int endSize = end.size();
-
-    while (1) {
-        if (write(m_writePipe, cmd, strlen(cmd)) == strlen(cmd)) {
-            break;
-        }
-    }
-
-    if(readOutput) {
-        char byte = 0;
-        while (read(m_readPipe, &byte, 1) == 1) {
-            ret += byte;
-
-            std::string comp;
-            int retSize = ret.size();
-            if (retSize < endSize) {
+/*
+ * Collects the elements of a list of groups as printed by GAP,
+ * i.e. "[ Group(()), Group([ (1,2) ]), ... ]", while it is read in.
+ * Whitespace is dropped.
+ */
+struct GroupListParser {
+    void feed(const char *data, std::size_t size) {
+        for (std::size_t i = 0; i < size; i++) {
+            const char c = data[i];
+
+            if (std::isspace(c) || c == '\\') {
                 continue;
-            } else {
-                comp = ret.substr(retSize - endSize);
             }
-            if (!end.compare(comp)) {
-                break;
+            if (c == ',' && depth == 1) {
+                flush();
+            } else if (c == '[' || c == '(') {
+                if (depth >= 1) {
+                    current += c;
+                }
+                depth++;
+            } else if (c == ']' || c == ')') {
+                depth--;
+                if (depth >= 1) {
+                    current += c;
+                } else {
+                    flush();
+                }
+            } else if (depth >= 1) {
+                current += c;
             }
         }
     }
-    ret.erase(std::remove(ret.begin(), ret.end(), '\n'), ret.end());
+    void flush() {
+        if (!current.empty()) {
+            groups.push_back(current);
+            current.clear();
+        }
+    }
 
-    return ret;
-}
+    int depth = 0;
+    std::string current;
+    std::vector<std::string> groups;
+};
 
 void AutGroup::gapCreateGroup(int d, bool product)
 {
@@ -77,167 +80,87 @@ void AutGroup::gapCreateGroup(int d, bool product)
 
     if (product) {
         // direct product S_d with S_2
-        gap_eval("Sd:=" + sDCmdGenerate(), false);
-        gap_eval("S2:=Group((1,2));;\n", false);
-        gap_eval("G:=DirectProduct(Sd, S2);;\n", false);
+        m_gap->eval("Sd:=" + sDCmdGenerate());
+        m_gap->eval("S2:=Group((1,2));;\n");
+        m_gap->eval("G:=DirectProduct(Sd, S2);;\n");
     } else {
         // S_d
-        gap_eval("G:=" + sDCmdGenerate(), false);
+        m_gap->eval("G:=" + sDCmdGenerate());
     }
 }
 
 AutGroup::AutGroup(int d, int k)
+    : m_pointCount(d == 2*k ? d + 2 : d),
+      m_gap(new GapPipe())
 {
-    int pipeStdIn[2];
-    int pipeStdOut[2];
-    pipe(pipeStdIn);
-    pipe(pipeStdOut);
-
-    pid_t pid = 0;
-    pid = fork();
-
-    if (pid == 0) {
-        // child
-
-      dup2(pipeStdIn[0], STDIN_FILENO);
-      dup2(pipeStdOut[1], STDOUT_FILENO);
-
-      close(pipeStdIn[0]);
-      close(pipeStdOut[1]);
-      close(pipeStdIn[1]);
-      close(pipeStdOut[0]);
-
-      std::string lineLength = std::to_string(50);
-      int childRet = execlp("gap", "gap", "-q", "-m", "64M", "-x", lineLength.c_str(), (char*) NULL);
-
-      qDebug() << "Critical fork error" << childRet;
-      exit(childRet);
-    }
-
-    // parent
-    close(pipeStdIn[0]);
-    close(pipeStdOut[1]);
-
-    m_readPipe = pipeStdOut[0];
-    m_writePipe = pipeStdIn[1];
-
-    if (d == 2*k) {
-        // direct product S_d with S_2
-        m_factorizations.reserve(2 * factorial(d));
-
-    } else {
-        // S_d
-        m_factorizations.reserve(factorial(d));
-    }
-
     gapCreateGroup(d, d == 2*k);
-    m_gapName = gap_eval("G;\n", true, "\n");
+    m_gapName = m_gap->eval("G;\n");
+    m_generators = parseGapGenerators(m_gapName, m_pointCount);
 
     qDebug() << "Full automorphism group:" << m_gapName.c_str();
-
-    createFactoredElements();
-    calcSubgroups();
 }
 
-AutGroup::~AutGroup()
+AutGroup::AutGroup(const GroupCacheData &cached)
+    : m_subgroups(cached.subgroups),
+      m_subgroupGenerators(cached.subgroupGenerators),
+      m_gapName(cached.groupName),
+      m_pointCount(cached.pointCount),
+      m_generators(parseGapGenerators(cached.groupName, cached.pointCount))
 {
-    delete[] m_subFactorizations;
-    m_subFactorizations = nullptr;
+    qDebug() << "Full automorphism group (cached):" << m_gapName.c_str();
 }
 
-void AutGroup::calcSubgroups()
+AutGroup::~AutGroup()
 {
-    m_subgroups.clear();
-    m_subgroups.push_back("Group(())");
-    delete[] m_subFactorizations;
-    m_subFactorizations = nullptr;
-
-    std::string subgroupList = gap_eval("Subs:=AllSubgroups(G);\n", true, ") ]\n");
-
-    std::size_t limit = 6;
-    bool cont = true;
-
-    while (cont) {
-        std::size_t pos = subgroupList.find("Group", limit);
-
-        limit = subgroupList.find("]),", pos);
-
-        if (limit == std::string::npos) {
-            cont = false;
-            limit = subgroupList.find("]) ]", pos);
-        }
-        limit += 2;
-
-        std::string subgr = subgroupList.substr(pos, limit - pos);
-        subgr.erase(remove_if(subgr.begin(), subgr.end(), ::isspace), subgr.end());
-        m_subgroups.push_back(subgr);
-    }
-    m_subFactorizations = new std::vector<std::string>[m_subgroups.size()];
-
-    qDebug() << "-----------------";
-    qDebug() << "Subgroup Count" << m_subgroups.size();
-    qDebug() << "-----------------";
+    delete m_gap;
 }
 
-static std::vector<std::string> splitFactoredElements(std::string elements)
+void AutGroup::interrupt()
 {
-    std::vector<std::string> ret;
-
-    std::size_t start = elements.find_first_of("<x(");
-    if (start == std::string::npos) {
-        return ret;
+    if (m_gap) {
+        m_gap->terminate();
     }
-    elements.erase(0, start);
-
-    bool cont = true;
-    while (cont) {
-        std::size_t limit = elements.find(',');
-        if (limit == std::string::npos) {
-            cont = false;
-            limit = elements.find(']') - 1;
-        }
-        std::string el = elements.substr(0, limit);
-        el.erase(remove_if(el.begin(), el.end(), ::isspace), el.end());
-        ret.push_back(el);
-
-        elements.erase(0, limit + 2);
-    }
-    return ret;
 }
 
-void AutGroup::createFactoredElements()
+void AutGroup::fillCacheData(GroupCacheData &data) const
 {
-    m_factorizations.clear();
-
-    gap_eval("l:=[];;\n", false);
-
-    std::string facs = gap_eval("for g in G do Add(l, Factorization(G,g)); od;l;\n", true, "]");
-    m_factorizations = splitFactoredElements(facs);
-
-    qDebug() << "-----------------";
-    qDebug() << "Group element count" << m_factorizations.size();
-    qDebug() << "-----------------";
+    data.pointCount = m_pointCount;
+    data.groupName = m_gapName;
+    data.subgroups = m_subgroups;
+    data.subgroupGenerators = m_subgroupGenerators;
 }
 
-std::vector<std::string> AutGroup::getFactorizations(int subIndex) const
+bool AutGroup::calcSubgroups(int subgroupMode)
 {
-    if (subIndex == -1) {
-        return m_factorizations;
-    }
-
-    std::string subgroup = m_subgroups[subIndex];
+    TRACE_SCOPE("AutGroup::calcSubgroups");
 
-    if (gap_eval(subgroup + "=" + m_gapName + ";\n", true, "e").substr(0, 4) == "true") {
-        return m_factorizations;
+    m_subgroups.clear();
+    m_subgroupGenerators.clear();
+    if (m_gapName.empty()) {
+        // GAP didn't even create the group
+        qDebug() << "Warning: No group from GAP, no subgroups calculated";
+        return false;
     }
-    if (m_subFactorizations[subIndex].size() > 0) {
-        return m_subFactorizations[subIndex];
+
+    const std::string cmd = subgroupMode == 1 ?
+                "Subs:=List(ConjugacyClassesSubgroups(G), Representative);\n" :
+                "Subs:=AllSubgroups(G);\n";
+
+    GroupListParser parser;
+    const bool ok = m_gap->eval(cmd, [&parser](const char *data, std::size_t size) {
+        parser.feed(data, size);
+    });
+    // the trivial group is always a subgroup, an unclosed list was cut off
+    if (!ok || parser.depth != 0 || parser.groups.empty()) {
+        qDebug() << "Warning: GAP failed to calculate the subgroups";
+        return false;
     }
+    m_subgroups = parser.groups;
 
-    gap_eval("l:=[];;\n", false);
-    gap_eval("for g in " + subgroup + " do Add(l, Factorization(G,g)); od;\n", false);
-    std::string facs = gap_eval("l;\n", true, "]");
+    for (auto sub : m_subgroups) {
+        m_subgroupGenerators.push_back(parseGapGenerators(sub, m_pointCount));
+    }
 
-    m_subFactorizations[subIndex] = splitFactoredElements(facs);
-    return m_subFactorizations[subIndex];
+    qDebug() << "Subgroup count:" << m_subgroups.size();
+    return true;
 }
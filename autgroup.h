@@ -22,35 +22,61 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <vector>
 #include <string>
 
+#include "gappipe.h"
+#include "groupcache.h"
+#include "permgroup.h"
+
 class AutGroup {
 public:
     AutGroup(int d, int k);
+    // restores a group computed before, without starting GAP
+    AutGroup(const GroupCacheData &cached);
     ~AutGroup();
 
+    void fillCacheData(GroupCacheData &data) const;
+
+    /*
+     * Subgroups of the group, computed by GAP. Subgroup mode 0 lists all
+     * subgroups, mode 1 one representative of every conjugacy class.
+     * Returns false and leaves no subgroups if GAP failed.
+     */
+    bool calcSubgroups(int subgroupMode = 0);
+
+    // stops a running calcSubgroups, may be called from another thread
+    void interrupt();
+
+    const std::vector<Permutation> &getGenerators() const {
+        return m_generators;
+    }
+
     std::vector<std::string> getSubgroups() const {
         return m_subgroups;
     }
 
-    std::vector<std::string> getFactorizations(int subIndex = -1) const;
+    // number of points the group acts on: d for S_d and d+2 for S_d x S_2
+    int pointCount() const {
+        return m_pointCount;
+    }
+    const std::vector<Permutation> &getSubgroupGenerators(int subIndex) const {
+        return m_subgroupGenerators[subIndex];
+    }
+    PermGroup getSubgroup(int subIndex) const {
+        return PermGroup(m_pointCount, m_subgroupGenerators[subIndex]);
+    }
 
 private:
-    void calcSubgroups();
-    void createFactoredElements();
-
     void calcVtxTrnsSubgroups();
 
     void gapCreateGroup(int d, bool product);
-    std::string gap_eval(const std::string _cmd, bool readOutput = true, std::string end = std::string()) const;
 
-    std::vector<std::string> m_factorizations;
     std::vector<std::string> m_subgroups;
-
-    std::vector<std::string> *m_subFactorizations = nullptr;
+    std::vector<std::vector<Permutation> > m_subgroupGenerators;
 
     std::string m_gapName;
+    int m_pointCount;
+    std::vector<Permutation> m_generators;
 
-    int m_writePipe;
-    int m_readPipe;
+    GapPipe *m_gap = nullptr;
 };
 
 #endif // AUTGROUP_H
@@ -18,8 +18,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "backend.h"
 #include "hypersimplex.h"
+#include "hypersimplexjob.h"
 #include "gimatrix.h"
+#include "gimatrixcache.h"
 
+#include <QFutureWatcher>
 #include <QtConcurrent/QtConcurrentRun>
 
 BackEnd::BackEnd(QObject *parent) :
@@ -28,34 +31,106 @@ BackEnd::BackEnd(QObject *parent) :
 
 BackEnd::~BackEnd()
 {
-    if (::s_hypers) {
-        delete ::s_hypers;
-        ::s_hypers = nullptr;
-    }
+    // a running job is a child and waits for its canceled construction
     delete m_reprMatrix;
+    delete m_matrixCache;
+    delete m_hypers;
 }
 
 facet_pair BackEnd::getFacetPair(int index) const
 {
-    if (::s_hypers = nullptr) {
+    if (!m_hypers) {
         return facet_pair(std::vector<Vertex>(), std::vector<Vertex>());
     }
-    return ::s_hypers->getFacetPair(index);
+    return m_hypers->getFacetPair(index);
 }
 
 void BackEnd::createHypersimplex(int d, int k)
 {
+    if (m_job) {
+        // the stale job stops at its next check and deletes itself
+        m_job->cancel();
+        disconnect(m_job, nullptr, this, nullptr);
+        m_job = nullptr;
+    }
+
     m_ready = false;
     emit readyChanged();
+    setProgress(0., QString());
+
+    m_vtxTrSubgroups.clear();
+    emit vtxTrSubgroupsChanged();
+    if (m_selectedSubgroup != 0) {
+        m_selectedSubgroup = 0;
+        emit selectedSubgroupChanged();
+    }
+    setGiMatrix(0);
+    setEecWraps();
 
-    setVtxTrSubgroups(std::vector<std::string>());
-    setSelectedSubgroup(0);
+    releaseHypersimplex();
 
-    QtConcurrent::run(::s_createHypersimplex, d, k);
+    m_job = new HypersimplexJob(d, k, m_subgroupMode, this);
+    connect(m_job, &HypersimplexJob::stageStarted, this, &BackEnd::onStageStarted);
+    connect(m_job, &HypersimplexJob::finished, this, &BackEnd::onJobFinished);
+    m_job->start();
+}
 
-    m_checkReadyTimer = new QTimer(this);
-    connect(m_checkReadyTimer, SIGNAL(timeout()), this, SLOT(checkReady()));
-    m_checkReadyTimer->start(1000);
+void BackEnd::onStageStarted(int stage, int stageCount, const QString &name)
+{
+    // queued, the job might be canceled by now
+    if (sender() != m_job) {
+        return;
+    }
+    setProgress((double)stage / stageCount, name);
+}
+
+void BackEnd::onJobFinished()
+{
+    HypersimplexJob *job = qobject_cast<HypersimplexJob *>(sender());
+    if (!job || job != m_job) {
+        return;
+    }
+    m_job = nullptr;
+    m_hypers = job->takeResult();
+
+    m_ready = true;
+    emit readyChanged();
+    setProgress(1., QString());
+
+    if (m_hypers) {
+        m_matrixCache = new GiMatrixCache(m_hypers, m_selEigenvectMode, m_eigenSolverMode);
+        // requests the first subgroup for display
+        setVtxTrSubgroups(m_hypers->getVtxTrSubgroupNames());
+        m_matrixCache->startPrefetch(m_selectedSubgroup + 1);
+    }
+}
+
+void BackEnd::releaseHypersimplex()
+{
+    GiMatrixCache *cache = m_matrixCache;
+    Hypersimplex *hypers = m_hypers;
+    m_matrixCache = nullptr;
+    m_hypers = nullptr;
+    if (!cache && !hypers) {
+        return;
+    }
+    if (cache) {
+        cache->stop();
+    }
+    // a build of the cache can still be running, it needs the hypersimplex until it ends
+    QtConcurrent::run(&m_releasePool, [cache, hypers]() {
+        delete cache;
+        delete hypers;
+    });
+}
+
+void BackEnd::setProgress(double progress, const QString &text)
+{
+    if (m_progress != progress || m_progressText != text) {
+        m_progress = progress;
+        m_progressText = text;
+        emit progressChanged();
+    }
 }
 
 void BackEnd::setSelectedSubgroup(int set) {
@@ -75,11 +150,45 @@ void BackEnd::setSelEigenvectMode(int mode)
             m_reprMatrix->setSelEigenvectMode(mode);
             m_reprMatrix->calcNullspaceRepr();
         }
+        if (m_matrixCache) {
+            m_matrixCache->setSolverModes(m_selEigenvectMode, m_eigenSolverMode);
+            if (m_matrixPending) {
+                // the pending matrix has the old mode
+                setGiMatrix(m_selectedSubgroup);
+            }
+        }
         emit selEigenvectModeChanged();
         emit geometryInitNeeded();
     }
 }
 
+void BackEnd::setEigenSolverMode(int mode)
+{
+    if (m_eigenSolverMode != mode) {
+        m_eigenSolverMode = mode;
+        if(m_reprMatrix) {
+            m_reprMatrix->setEigenSolverMode(mode);
+            m_reprMatrix->calcNullspaceRepr();
+        }
+        if (m_matrixCache) {
+            m_matrixCache->setSolverModes(m_selEigenvectMode, m_eigenSolverMode);
+            if (m_matrixPending) {
+                setGiMatrix(m_selectedSubgroup);
+            }
+        }
+        emit eigenSolverModeChanged();
+        emit geometryInitNeeded();
+    }
+}
+
+void BackEnd::setSubgroupMode(int mode)
+{
+    if (m_subgroupMode != mode) {
+        m_subgroupMode = mode;
+        emit subgroupModeChanged();
+    }
+}
+
 void BackEnd::setEecWraps() {
     auto clear = [this]() {
         for (auto eW : m_eecWraps) {
@@ -105,6 +214,9 @@ void BackEnd::setEecWraps() {
 
 void BackEnd::setVars(QList<double > vars)
 {
+    if (!m_reprMatrix) {
+        return;
+    }
     m_reprMatrix->setVars(vars.toVector().toStdVector());
     emit geometryUpdateNeeded();
 }
@@ -112,30 +224,36 @@ void BackEnd::setVars(QList<double > vars)
 void BackEnd::setGiMatrix(int subgroup)
 {
     delete m_reprMatrix;
+    m_reprMatrix = nullptr;
+    // answers to earlier requests are dropped
+    const int request = ++m_matrixRequest;
+    m_matrixPending = false;
 
-    m_reprMatrix = new GiMatrix(::s_hypers->getGiMatrix(subgroup));
-    m_reprMatrix->setSelEigenvectMode(m_selEigenvectMode);
-    m_reprMatrix->init();
-
-    emit geometryInitNeeded();
-}
-
-void BackEnd::checkReady()
-{
-    if (!::s_ready) {
-        return;
-    }
-
-    if (!m_ready) {
-        m_ready = ::s_ready;
-        emit readyChanged();
-
-        if (m_checkReadyTimer) {
-            delete m_checkReadyTimer;
-            m_checkReadyTimer = nullptr;
+    if (m_matrixCache && subgroup >= 0 && subgroup < m_vtxTrSubgroups.size()) {
+        auto cached = m_matrixCache->find(subgroup);
+        if (cached) {
+            m_reprMatrix = new GiMatrix(*cached);
+        } else {
+            // built on the thread pool, shown once it is there
+            typedef std::shared_ptr<const GiMatrix> MatrixPtr;
+            auto watcher = new QFutureWatcher<MatrixPtr>(this);
+            connect(watcher, &QFutureWatcher<MatrixPtr>::finished, this, [this, watcher, request]() {
+                watcher->deleteLater();
+                const MatrixPtr matrix = watcher->result();
+                if (request != m_matrixRequest || !matrix) {
+                    return;
+                }
+                m_matrixPending = false;
+                m_reprMatrix = new GiMatrix(*matrix);
+                setEecWraps();
+                emit geometryInitNeeded();
+            });
+            watcher->setFuture(m_matrixCache->request(subgroup));
+            m_matrixPending = true;
         }
-        setVtxTrSubgroups(::s_hypers->getVtxTrSubgroupNames());
     }
+
+    emit geometryInitNeeded();
 }
 
 void BackEnd::setVtxTrSubgroups(std::vector<std::string> subNames)
@@ -20,14 +20,17 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define BACKEND_H
 
 #include <QObject>
-#include <QTimer>
 #include <QStringList>
+#include <QThreadPool>
 
 #include <vector>
 
 #include <vertex.h>
 
 class GiMatrix;
+class GiMatrixCache;
+class Hypersimplex;
+class HypersimplexJob;
 
 typedef std::pair<std::vector<Vertex>, std::vector<Vertex> > facet_pair;
 
@@ -65,9 +68,13 @@ class BackEnd : public QObject
     Q_OBJECT
 
     Q_PROPERTY(bool ready READ ready NOTIFY readyChanged)
+    Q_PROPERTY(double progress READ progress NOTIFY progressChanged)
+    Q_PROPERTY(QString progressText READ progressText NOTIFY progressChanged)
     Q_PROPERTY(QStringList vtxTrSubgroups READ vtxTrSubgroups NOTIFY vtxTrSubgroupsChanged)
     Q_PROPERTY(int selectedSubgroup READ selectedSubgroup WRITE setSelectedSubgroup NOTIFY selectedSubgroupChanged)
     Q_PROPERTY(int selEigenvectMode READ selEigenvectMode WRITE setSelEigenvectMode NOTIFY selEigenvectModeChanged)
+    Q_PROPERTY(int eigenSolverMode READ eigenSolverMode WRITE setEigenSolverMode NOTIFY eigenSolverModeChanged)
+    Q_PROPERTY(int subgroupMode READ subgroupMode WRITE setSubgroupMode NOTIFY subgroupModeChanged)
 
     Q_PROPERTY(QList<QObject*> eecWraps READ eecWraps NOTIFY eecWrapsChanged)
 
@@ -81,6 +88,13 @@ public:
     bool ready() const {
         return m_ready;
     }
+    // of the hypersimplex construction
+    double progress() const {
+        return m_progress;
+    }
+    QString progressText() const {
+        return m_progressText;
+    }
     QList<QString> vtxTrSubgroups() const {
         return m_vtxTrSubgroups;
     }
@@ -96,6 +110,17 @@ public:
     }
     void setSelEigenvectMode(int mode);
 
+    int eigenSolverMode() const {
+        return m_eigenSolverMode;
+    }
+    void setEigenSolverMode(int mode);
+
+    // used for the next hypersimplex
+    int subgroupMode() const {
+        return m_subgroupMode;
+    }
+    void setSubgroupMode(int mode);
+
     GiMatrix *getGiMatrix() {
         return m_reprMatrix;
     }
@@ -107,30 +132,53 @@ public:
 
     facet_pair getFacetPair(int index = 0) const;
 
-public Q_SLOTS:
-    void checkReady();
-
 Q_SIGNALS:
     void readyChanged();
+    void progressChanged();
     void vtxTrSubgroupsChanged();
     void selectedSubgroupChanged();
     void eecWrapsChanged();
     void geometryInitNeeded();
     void geometryUpdateNeeded();
     void selEigenvectModeChanged();
+    void eigenSolverModeChanged();
+    void subgroupModeChanged();
+
+private Q_SLOTS:
+    void onStageStarted(int stage, int stageCount, const QString &name);
+    void onJobFinished();
 
 private:
+    // may only request the matrix, which is set later then
     void setGiMatrix(int subgroup);
+    // deletes the hypersimplex and its cache in the background
+    void releaseHypersimplex();
+    void setProgress(double progress, const QString &text);
+
+    Hypersimplex *m_hypers = nullptr;
+    // representations of all subgroups, prefetched once m_hypers is ready
+    GiMatrixCache *m_matrixCache = nullptr;
+    HypersimplexJob *m_job = nullptr;
+    /*
+     * Released caches wait there for their requests on the global pool,
+     * which must not be blocked by them. Waits for them on destruction.
+     */
+    QThreadPool m_releasePool;
 
-    QTimer *m_checkReadyTimer = nullptr;
     bool m_ready = true;
+    double m_progress = 0.;
+    QString m_progressText;
 
     QStringList m_vtxTrSubgroups;
     int m_selectedSubgroup = 0;
     GiMatrix *m_reprMatrix = nullptr;
+    int m_matrixRequest = 0;
+    bool m_matrixPending = false;
 
     QList<QObject*> m_eecWraps;
     int m_selEigenvectMode = 0;
+    int m_eigenSolverMode = 0;
+    int m_subgroupMode = 0;
 };
 
 #endif // BACKEND_H
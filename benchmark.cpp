@@ -0,0 +1,320 @@
+/*********************************************************************
+Hypersimplex Representer
+Copyright (C) 2017 Roman Gilg
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#include "autgroup.h"
+#include "hypersimplex.h"
+#include "gimatrix.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+
+/*
+ * Times every stage of the pipeline for a list of (d, k) and writes the
+ * results as JSON, in the layout of Google Benchmark reports. Times are
+ * wall clock. Peak memory is the high water mark of the resident set
+ * during the stage, if the kernel allows resetting it, otherwise the peak
+ * of the process up to the end of the stage.
+ */
+
+// makes the construction stages callable one by one, without group cache
+template<typename Hypers>
+class StagedHypers : public Hypers {
+public:
+    StagedHypers(int d, int k, int subgroupMode)
+        : Hypers(d, k, subgroupMode, nullptr, false)
+    {}
+
+    using Hypers::initVertices;
+    using Hypers::initEdges;
+    using Hypers::initSubgroups;
+    using Hypers::calcVtxTrnsSubgroups;
+    using Hypers::calcEdgeEquivClasses;
+
+    void createGroup() {
+        this->m_group = new AutGroup(this->m_d, this->m_k);
+    }
+};
+
+static bool resetPeakRss()
+{
+    // resets VmHWM since Linux 4.0
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+    clearRefs.close();
+    return !clearRefs.fail();
+}
+
+static long peakRssKb()
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return atol(line.c_str() + 6);
+        }
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+class StageBenchmark {
+public:
+    StageBenchmark(int repetitions, int eigenSolverMode, int subgroupMode)
+        : m_repetitions(repetitions),
+          m_eigenSolverMode(eigenSolverMode),
+          m_subgroupMode(subgroupMode)
+    {}
+
+    void run(int d, int k);
+    void writeJson(std::ostream &out) const;
+
+private:
+    template<typename Hypers>
+    void runStages(int d, int k);
+
+    struct Result {
+        std::string name;
+        std::string stage;
+        int d;
+        int k;
+        int subgroup;
+        std::vector<double> times;
+        long peakRssKb = 0;
+    };
+
+    template<typename Stage>
+    void measure(const std::string &stage, int d, int k, int subgroup, Stage run);
+
+    int m_repetitions;
+    int m_eigenSolverMode;
+    int m_subgroupMode;
+    bool m_peakRssPerStage = true;
+
+    std::vector<Result> m_results;
+    std::map<std::string, int> m_resultIndices;
+};
+
+template<typename Stage>
+void StageBenchmark::measure(const std::string &stage, int d, int k, int subgroup, Stage run)
+{
+    std::string name = stage + "/" + std::to_string(d) + "/" + std::to_string(k);
+    if (subgroup >= 0) {
+        name += "/" + std::to_string(subgroup);
+    }
+
+    auto it = m_resultIndices.find(name);
+    if (it == m_resultIndices.end()) {
+        Result result;
+        result.name = name;
+        result.stage = stage;
+        result.d = d;
+        result.k = k;
+        result.subgroup = subgroup;
+        it = m_resultIndices.insert(std::make_pair(name, (int)m_results.size())).first;
+        m_results.push_back(result);
+    }
+    Result &result = m_results[it->second];
+
+    m_peakRssPerStage = resetPeakRss() && m_peakRssPerStage;
+
+    const auto start = std::chrono::steady_clock::now();
+    run();
+    const auto end = std::chrono::steady_clock::now();
+
+    result.times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    result.peakRssKb = std::max(result.peakRssKb, peakRssKb());
+}
+
+void StageBenchmark::run(int d, int k)
+{
+    if (d == 2 * k) {
+        runStages<SymHypers>(d, k);
+    } else {
+        runStages<AsymHypers>(d, k);
+    }
+}
+
+template<typename Hypers>
+void StageBenchmark::runStages(int d, int k)
+{
+    for (int rep = 0; rep < m_repetitions; rep++) {
+        StagedHypers<Hypers> hypers(d, k, m_subgroupMode);
+
+        measure("vertex_init", d, k, -1, [&hypers]() {
+            hypers.initVertices();
+        });
+        measure("edges", d, k, -1, [&hypers]() {
+            hypers.initEdges();
+        });
+        measure("group", d, k, -1, [&hypers]() {
+            hypers.createGroup();
+        });
+        measure("subgroups", d, k, -1, [&hypers]() {
+            hypers.initSubgroups();
+        });
+        measure("vertex_transitivity", d, k, -1, [&hypers]() {
+            hypers.calcVtxTrnsSubgroups();
+        });
+        measure("eecs", d, k, -1, [&hypers]() {
+            hypers.calcEdgeEquivClasses();
+        });
+
+        const int subgroupCount = hypers.getVtxTrSubgroupNames().size();
+        for (int sub = 0; sub < subgroupCount; sub++) {
+            GiMatrix matrix = hypers.getGiMatrix(sub);
+            matrix.setEigenSolverMode(m_eigenSolverMode);
+
+            measure("gimatrix", d, k, sub, [&matrix]() {
+                matrix.calculateEecIndexMatrix();
+                matrix.assembleVars(std::vector<double>());
+            });
+
+            measure("eigensolve", d, k, sub, [&matrix]() {
+                matrix.calcNullspaceRepr();
+            });
+
+            if (matrix.getNullspaceRepr().empty()) {
+                continue;
+            }
+            measure("schlegel", d, k, sub, [&matrix]() {
+                int error = 0;
+                matrix.getSchlegelDiagram(0, true, error);
+            });
+        }
+    }
+}
+
+void StageBenchmark::writeJson(std::ostream &out) const
+{
+    char date[32];
+    const std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    out << "{\n";
+    out << "  \"context\": {\n";
+    out << "    \"date\": \"" << date << "\",\n";
+    out << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+    out << "    \"repetitions\": " << m_repetitions << ",\n";
+    out << "    \"eigensolver_mode\": " << m_eigenSolverMode << ",\n";
+    out << "    \"subgroup_mode\": " << m_subgroupMode << ",\n";
+    out << "    \"peak_rss_per_stage\": " << (m_peakRssPerStage ? "true" : "false") << "\n";
+    out << "  },\n";
+    out << "  \"benchmarks\": [";
+
+    for (std::size_t i = 0; i < m_results.size(); i++) {
+        const Result &result = m_results[i];
+
+        double sum = 0;
+        for (double t : result.times) {
+            sum += t;
+        }
+        const auto minMax = std::minmax_element(result.times.begin(), result.times.end());
+
+        out << (i ? "," : "") << "\n    {\n";
+        out << "      \"name\": \"" << result.name << "\",\n";
+        out << "      \"stage\": \"" << result.stage << "\",\n";
+        out << "      \"d\": " << result.d << ",\n";
+        out << "      \"k\": " << result.k << ",\n";
+        if (result.subgroup >= 0) {
+            out << "      \"subgroup\": " << result.subgroup << ",\n";
+        }
+        out << "      \"repetitions\": " << result.times.size() << ",\n";
+        out << "      \"real_time\": " << sum / result.times.size() << ",\n";
+        out << "      \"min_time\": " << *minMax.first << ",\n";
+        out << "      \"max_time\": " << *minMax.second << ",\n";
+        out << "      \"time_unit\": \"ms\",\n";
+        out << "      \"peak_rss_kb\": " << result.peakRssKb << "\n";
+        out << "    }";
+    }
+    out << "\n  ]\n}\n";
+}
+
+static void printUsage(const char *name)
+{
+    std::cerr << "Usage: " << name << " [-o output] [-r repetitions] [-e eigensolverMode] [-g subgroupMode] [d,k ...]" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    std::string outputPath;
+    int repetitions = 3;
+    int eigenSolverMode = 0;
+    int subgroupMode = 0;
+    std::vector<std::pair<int, int> > sizes;
+
+    for (int arg = 1; arg < argc; arg++) {
+        const std::string opt = argv[arg];
+        if (opt == "-o" || opt == "-r" || opt == "-e" || opt == "-g") {
+            if (arg + 1 >= argc) {
+                printUsage(argv[0]);
+                return 1;
+            }
+            const char *val = argv[++arg];
+            if (opt == "-o") {
+                outputPath = val;
+            } else if (opt == "-r") {
+                repetitions = std::max(1, atoi(val));
+            } else if (opt == "-e") {
+                eigenSolverMode = atoi(val);
+            } else {
+                subgroupMode = atoi(val);
+            }
+            continue;
+        }
+
+        int d, k;
+        if (sscanf(opt.c_str(), "%d,%d", &d, &k) != 2 || k <= 0 || d <= k) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        sizes.push_back(std::make_pair(d, k));
+    }
+
+    if (sizes.empty()) {
+        sizes = {{4, 2}, {5, 2}, {6, 2}, {6, 3}, {7, 2}, {7, 3}};
+    }
+
+    StageBenchmark benchmark(repetitions, eigenSolverMode, subgroupMode);
+    for (auto size : sizes) {
+        benchmark.run(size.first, size.second);
+    }
+
+    if (outputPath.empty()) {
+        benchmark.writeJson(std::cout);
+        return 0;
+    }
+    std::ofstream output(outputPath);
+    if (!output) {
+        std::cerr << "Could not open output file " << outputPath << std::endl;
+        return 1;
+    }
+    benchmark.writeJson(output);
+    return 0;
+}
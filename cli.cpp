@@ -0,0 +1,241 @@
+/*********************************************************************
+Hypersimplex Representer
+Copyright (C) 2017 Roman Gilg
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#include "hypersimplex.h"
+#include "gimatrix.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+ * Headless driver. Every job is a line "d k subgroup[:conjugate] [x_1 ... x_n]",
+ * where subgroup indexes the vertex-transitive subgroups, conjugate one of
+ * its conjugates (see Hypersimplex::getConjugators) and the optional
+ * variables are the EEC values passed to GiMatrix::setVars.
+ */
+
+struct Job {
+    int d = 0;
+    int k = 0;
+    int subgroup = 0;
+    int conjugate = 0;
+    std::vector<double> vars;
+};
+
+static void printUsage(const char *name)
+{
+    std::cerr << "Usage: " << name << " [-o output] [-e eigensolverMode] [-s selectionMode] [-g subgroupMode]"
+              << " (-f jobfile | d k subgroup[:conjugate] [x_1 ... x_n])" << std::endl
+              << "Job file lines: d k subgroup[:conjugate] [x_1 ... x_n], '#' starts a comment." << std::endl;
+}
+
+static bool parseJob(std::istream &in, Job &job)
+{
+    if (!(in >> job.d >> job.k >> job.subgroup)) {
+        return false;
+    }
+    if (in.peek() == ':' && !(in.ignore() >> job.conjugate)) {
+        return false;
+    }
+    double x;
+    while (in >> x) {
+        job.vars.push_back(x);
+    }
+    return in.eof();
+}
+
+static Hypersimplex *createHypersimplex(int d, int k, int subgroupMode)
+{
+    if (k <= 0 || d <= 1 || d <= k) {
+        return nullptr;
+    }
+    if (d == 2 * k) {
+        return new SymHypers(d, k, subgroupMode);
+    }
+    return new AsymHypers(d, k, subgroupMode);
+}
+
+static void writeResult(std::ostream &out, int jobIndex, const Job &job,
+                        const std::string &subgroupName, const GiMatrix &matrix)
+{
+    const auto repr = job.conjugate ? matrix.getConjugateNullspaceRepr(job.conjugate)
+                                    : matrix.getNullspaceRepr();
+
+    out << "job " << jobIndex << " d " << job.d << " k " << job.k
+        << " subgroup " << job.subgroup << " " << subgroupName;
+    if (job.conjugate) {
+        out << " conjugate " << job.conjugate;
+    }
+    out << "\n";
+    out << "vars";
+    for (double x : matrix.getVars()) {
+        out << " " << x;
+    }
+    out << "\n";
+    out << "dim " << (repr.empty() ? 0 : repr[0].rows()) << "\n";
+    for (const VectorXd &vertex : repr) {
+        for (int i = 0; i < vertex.rows(); i++) {
+            out << (i ? " " : "") << vertex(i);
+        }
+        out << "\n";
+    }
+    out << "end\n";
+}
+
+int main(int argc, char** argv)
+{
+    std::string outputPath;
+    std::string jobPath;
+    int eigenSolverMode = 0;
+    int selEigenvectMode = 0;
+    int subgroupMode = 0;
+
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-' && argv[arg][1] != '\0'; arg++) {
+        const char *opt = argv[arg];
+        if (arg + 1 >= argc || strlen(opt) != 2) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        const char *val = argv[++arg];
+        switch (opt[1]) {
+        case 'o':
+            outputPath = val;
+            break;
+        case 'f':
+            jobPath = val;
+            break;
+        case 'e':
+            eigenSolverMode = atoi(val);
+            break;
+        case 's':
+            selEigenvectMode = atoi(val);
+            break;
+        case 'g':
+            subgroupMode = atoi(val);
+            break;
+        default:
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<Job> jobs;
+    if (!jobPath.empty()) {
+        std::ifstream jobFile(jobPath);
+        if (!jobFile) {
+            std::cerr << "Could not open job file " << jobPath << std::endl;
+            return 1;
+        }
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(jobFile, line)) {
+            lineNumber++;
+            line = line.substr(0, line.find('#'));
+            if (line.find_first_not_of(" \t\r") == std::string::npos) {
+                continue;
+            }
+            std::istringstream lineStream(line);
+            Job job;
+            if (!parseJob(lineStream, job)) {
+                std::cerr << "Malformed job in line " << lineNumber << std::endl;
+                return 1;
+            }
+            jobs.push_back(job);
+        }
+    } else {
+        std::string jobLine;
+        for (; arg < argc; arg++) {
+            jobLine += std::string(argv[arg]) + " ";
+        }
+        std::istringstream lineStream(jobLine);
+        Job job;
+        if (!parseJob(lineStream, job)) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        jobs.push_back(job);
+    }
+
+    std::ofstream outputFile;
+    if (!outputPath.empty()) {
+        outputFile.open(outputPath);
+        if (!outputFile) {
+            std::cerr << "Could not open output file " << outputPath << std::endl;
+            return 1;
+        }
+    }
+    std::ostream &out = outputPath.empty() ? std::cout : outputFile;
+
+    // consecutive jobs on the same hypersimplex share its group computations
+    std::unique_ptr<Hypersimplex> hypers;
+    std::vector<std::string> subgroupNames;
+    int failed = 0;
+
+    for (int i = 0; i < (int)jobs.size(); i++) {
+        const Job &job = jobs[i];
+
+        if (!hypers || hypers->d() != job.d || hypers->k() != job.k) {
+            hypers.reset(createHypersimplex(job.d, job.k, subgroupMode));
+            if (!hypers) {
+                std::cerr << "Job " << i << ": invalid hypersimplex (" << job.d << ", " << job.k << ")" << std::endl;
+                failed++;
+                continue;
+            }
+            subgroupNames = hypers->getVtxTrSubgroupNames();
+        }
+
+        if (job.subgroup < 0 || job.subgroup >= (int)subgroupNames.size()) {
+            std::cerr << "Job " << i << ": no vertex-transitive subgroup " << job.subgroup
+                      << " (" << subgroupNames.size() << " available)" << std::endl;
+            failed++;
+            continue;
+        }
+        if (job.conjugate != 0) {
+            const int conjugateCount = hypers->getConjugateCount(job.subgroup);
+            if (job.conjugate < 0 || job.conjugate >= conjugateCount) {
+                std::cerr << "Job " << i << ": no conjugate " << job.conjugate << " of subgroup " << job.subgroup
+                          << " (" << conjugateCount << " available)" << std::endl;
+                failed++;
+                continue;
+            }
+        }
+
+        GiMatrix matrix = hypers->getGiMatrix(job.subgroup);
+        matrix.setSelEigenvectMode(selEigenvectMode);
+        matrix.setEigenSolverMode(eigenSolverMode);
+        // empty variables select the defaults, so every job solves once
+        matrix.calculateEecIndexMatrix();
+        if (!matrix.setVars(job.vars)) {
+            std::cerr << "Job " << i << ": invalid variables for " << matrix.getMultiplicities().size()
+                      << " edge equivalence classes" << std::endl;
+            failed++;
+            continue;
+        }
+
+        writeResult(out, i, job, subgroupNames[job.subgroup], matrix);
+    }
+
+    return failed ? 2 : 0;
+}
@@ -16,69 +16,174 @@ You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *********************************************************************/
 
-static int binomCoeff(int d, int k)
-{
-    if (d < k || k <= 0) {
-        return 0;
-    }
-    double ret = 1.;
-    for (int i = 1; i <= k; i++) {
-        ret *= (d + 1 - i) / (double) i;
-    }
-    return (int)(ret + 0.5);
-}
+#ifndef COMBINADIC_H
+#define COMBINADIC_H
+
+#include <cstddef>
+#include <cstdint>
 
 /*
- * Greedy algorithm for determining position
- * of k-combination.
+ * Largest dimension d the combinadic engine can handle.
  */
-static int combinadicCombMax(int k, int n, int &max)
-{
-    int i = k - 1;
-    max = 0;
+const int combinadicMaxDim = 128;
 
-    while (true) {
-        int nextTry = binomCoeff(i + 1, k);
-        if (nextTry > n) {
-            break;
+/*
+ * Pascal's triangle up to combinadicMaxDim in 64-bit integers.
+ *
+ * Binomials not representable in 64 bit saturate to UINT64_MAX. Since
+ * ranks are always smaller than C(d, k), comparisons against a saturated
+ * entry stay correct as long as C(d, k) itself fits.
+ */
+class PascalTable {
+public:
+    static const PascalTable &instance() {
+        static const PascalTable table;
+        return table;
+    }
+
+    uint64_t operator()(int n, int r) const {
+        if (n < 0 || r < 0 || r > n) {
+            return 0;
         }
-        max = nextTry;
-        i++;
+        return m_table[n][r];
     }
-    return i;
+
+private:
+    PascalTable() {
+        for (int n = 0; n <= combinadicMaxDim; n++) {
+            m_table[n][0] = 1;
+            m_table[n][n] = 1;
+            for (int r = 1; r < n; r++) {
+                uint64_t a = m_table[n - 1][r - 1];
+                uint64_t b = m_table[n - 1][r];
+                m_table[n][r] = a > UINT64_MAX - b ? UINT64_MAX : a + b;
+            }
+        }
+    }
+
+    uint64_t m_table[combinadicMaxDim + 1][combinadicMaxDim + 1];
+};
+
+static inline uint64_t binomial(int n, int r)
+{
+    return PascalTable::instance()(n, r);
+}
+
+static inline int binomCoeff(int d, int k)
+{
+    return (int)binomial(d, k);
 }
 
 /*
- * Calculates the ninSet's k-combination 'comb' in the
- * lexicographic combinadic ordering.
+ * Rank and unrank k-combinations of {0, ..., d-1} in the
+ * lexicographic combinadic (colex) ordering.
  *
- * nInSet starts counting at 0.
+ * A combination is either given as 0/1 array of length d or for
+ * d <= 64 as bitmask with bit i set for component i. Numeric order
+ * of the bitmasks coincides with the combinadic order.
  */
-static void combinadicComb(int k, int nInSet, int *comb)
-{
-    for (int i = k; i > 0; i--) {
-        int diff;
-        int combIndex = combinadicCombMax(i, nInSet, diff);
+class Combinadic {
+public:
+    Combinadic(int d, int k)
+        : m_d(d),
+          m_k(k),
+          m_table(PascalTable::instance())
+    {}
 
-        comb[combIndex] = 1;
-        nInSet = nInSet - diff;
+    int d() const {
+        return m_d;
+    }
+    int k() const {
+        return m_k;
+    }
+    uint64_t count() const {
+        return m_table(m_d, m_k);
     }
-}
 
-/*
- * Calculates the associated number to the
- * k-combination 'comb'.
- */
-static int combinadicN(int d, const int *comb)
-{
-    int n = 0;
-    int j = 1;
+    uint64_t rank(const int *comb) const {
+        uint64_t n = 0;
+        int j = 1;
+        for (int i = 0; i < m_d; i++) {
+            if (comb[i]) {
+                n += m_table(i, j);
+                j++;
+            }
+        }
+        return n;
+    }
 
-    for (int i = 0; i < d; i++) {
-        if (comb[i]) {
-            n += binomCoeff(i, j);
+    /*
+     * Expects 'comb' to be of size d. Every entry is written.
+     */
+    void unrank(uint64_t n, int *comb) const {
+        int r = m_k;
+        for (int i = m_d - 1; i >= 0; i--) {
+            const uint64_t c = m_table(i, r);
+            if (r > 0 && c <= n) {
+                comb[i] = 1;
+                n -= c;
+                r--;
+            } else {
+                comb[i] = 0;
+            }
+        }
+    }
+
+    uint64_t rankMask(uint64_t mask) const {
+        uint64_t n = 0;
+        int j = 1;
+        while (mask) {
+            n += m_table(__builtin_ctzll(mask), j);
+            mask &= mask - 1;
             j++;
         }
+        return n;
     }
-    return n;
-}
+
+    uint64_t unrankMask(uint64_t n) const {
+        uint64_t mask = 0;
+        int r = m_k;
+        for (int i = m_d - 1; i >= 0 && r > 0; i--) {
+            const uint64_t c = m_table(i, r);
+            if (c <= n) {
+                mask |= uint64_t(1) << i;
+                n -= c;
+                r--;
+            }
+        }
+        return mask;
+    }
+
+    void rankBatch(const uint64_t *masks, std::size_t count, uint64_t *ranks) const {
+        for (std::size_t i = 0; i < count; i++) {
+            ranks[i] = rankMask(masks[i]);
+        }
+    }
+
+    /*
+     * Writes the masks of the combinations first, ..., first + count - 1.
+     *
+     * Only the first one is unranked, all others are generated by
+     * stepping to the next larger integer of same popcount.
+     */
+    void unrankBatch(uint64_t first, std::size_t count, uint64_t *masks) const {
+        if (!count) {
+            return;
+        }
+        uint64_t mask = unrankMask(first);
+        masks[0] = mask;
+        for (std::size_t i = 1; i < count; i++) {
+            const uint64_t low = mask & (~mask + 1);
+            const uint64_t ripple = mask + low;
+            mask = ripple | (((mask ^ ripple) >> 2) / low);
+            masks[i] = mask;
+        }
+    }
+
+private:
+    int m_d;
+    int m_k;
+    const PascalTable &m_table;
+};
+
+#endif // COMBINADIC_H
@@ -16,35 +16,36 @@ You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *********************************************************************/
 
-#ifndef VERTEX3DENTITY_H
-#define VERTEX3DENTITY_H
-
-#include <vector>
-#include <eigen3/Eigen/Dense>
-
-#include <Qt3DCore/QEntity>
-#include <Qt3DExtras/QSphereMesh>
-#include <Qt3DCore/QTransform>
-#include <Qt3DExtras/QPhongMaterial>
-
-
-class Vertex3DEntity : public Qt3DCore::QEntity {
-public:
-    Vertex3DEntity(QNode *parent = nullptr);
-    Vertex3DEntity(QNode *parent, Eigen::VectorXd pos);
-
-    QVector3D pos() const {
-        return m_pos;
+#include "constructioncontrol.h"
+
+ConstructionControl::ConstructionControl(const StageCallback &onStage)
+    : m_onStage(onStage),
+      m_canceled(false)
+{
+}
+
+void ConstructionControl::cancel()
+{
+    std::lock_guard<std::mutex> lock(m_hookMutex);
+    m_canceled = true;
+    if (m_cancelHook) {
+        m_cancelHook();
     }
+}
 
-    void updateGeometry(Eigen::VectorXd pos);
-
-private:
-    Qt3DExtras::QSphereMesh *m_mesh;
-    Qt3DExtras::QPhongMaterial *m_material;
-    Qt3DCore::QTransform *m_transform;
-
-    QVector3D m_pos;
-};
-
-#endif // VERTEX3DENTITY_H
+void ConstructionControl::enterStage(int stage)
+{
+    if (m_onStage) {
+        m_onStage(stage);
+    }
+}
+
+void ConstructionControl::setCancelHook(const std::function<void()> &hook)
+{
+    std::lock_guard<std::mutex> lock(m_hookMutex);
+    m_cancelHook = hook;
+    // canceled while the hooked work was about to start
+    if (m_cancelHook && m_canceled) {
+        m_cancelHook();
+    }
+}
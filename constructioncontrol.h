@@ -0,0 +1,57 @@
+/*********************************************************************
+Hypersimplex Representer
+Copyright (C) 2017 Roman Gilg
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#ifndef CONSTRUCTIONCONTROL_H
+#define CONSTRUCTIONCONTROL_H
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+
+/*
+ * Shared between the thread constructing a hypersimplex and its owner.
+ * The owner is told about every stage when it starts and can cancel at
+ * any time. The construction then stops at its next check and leaves the
+ * hypersimplex incomplete.
+ */
+class ConstructionControl {
+public:
+    typedef std::function<void(int stage)> StageCallback;
+
+    explicit ConstructionControl(const StageCallback &onStage = StageCallback());
+
+    // may be called from any thread
+    void cancel();
+    bool isCanceled() const {
+        return m_canceled;
+    }
+
+    // called by the constructing thread
+    void enterStage(int stage);
+    // run by cancel() while set, to interrupt work that can't check the flag
+    void setCancelHook(const std::function<void()> &hook);
+
+private:
+    StageCallback m_onStage;
+    std::atomic<bool> m_canceled;
+
+    std::mutex m_hookMutex;
+    std::function<void()> m_cancelHook;
+};
+
+#endif // CONSTRUCTIONCONTROL_H
@@ -0,0 +1,191 @@
+/*********************************************************************
+Hypersimplex Representer
+Copyright (C) 2017 Roman Gilg
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#include "eigensolver.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace Eigen;
+
+/*
+ * Orthonormalizes the columns of basis in place. The first fixedCols columns
+ * must already be orthonormal and stay untouched. The others are projected
+ * out of them and orthonormalized through the eigendecomposition of their
+ * Gram matrix (SVQB), dropping linearly dependent directions. Everything is
+ * done blockwise and twice for numerical safety.
+ */
+static void orthonormalize(MatrixXd &basis, int fixedCols)
+{
+    const int rest = basis.cols() - fixedCols;
+    if (rest <= 0) {
+        return;
+    }
+    MatrixXd w = basis.rightCols(rest);
+
+    for (int pass = 0; pass < 2 && w.cols(); pass++) {
+        if (fixedCols) {
+            const auto fixed = basis.leftCols(fixedCols);
+            w -= fixed * (fixed.transpose() * w);
+            w -= fixed * (fixed.transpose() * w);
+        }
+
+        const VectorXd norms = w.colwise().norm();
+        MatrixXd scaled = w;
+        for (int col = 0; col < w.cols(); col++) {
+            scaled.col(col) /= std::max(norms(col), 1e-300);
+        }
+        SelfAdjointEigenSolver<MatrixXd> gram(scaled.transpose() * scaled);
+        const VectorXd &lambda = gram.eigenvalues();
+        const double threshold = 1e-10 * std::max(lambda.maxCoeff(), 1e-300);
+
+        int kept = 0;
+        while (kept < lambda.rows() && lambda(lambda.rows() - 1 - kept) > threshold) {
+            kept++;
+        }
+        const MatrixXd v = gram.eigenvectors().rightCols(kept);
+        w = scaled * v * lambda.tail(kept).cwiseSqrt().cwiseInverse().asDiagonal();
+    }
+
+    basis.conservativeResize(NoChange, fixedCols + w.cols());
+    basis.rightCols(w.cols()) = w;
+}
+
+PartialEigenSolver::PartialEigenSolver(int maxIterations, double tolerance)
+    : m_maxIterations(maxIterations),
+      m_tolerance(tolerance)
+{
+}
+
+void PartialEigenSolver::computeDense(const SparseMatrix<double> &matrix, int count)
+{
+    const MatrixXd dense(matrix);
+    SelfAdjointEigenSolver<MatrixXd> solver(dense);
+    m_eVals = solver.eigenvalues().tail(count);
+    m_eVcts = solver.eigenvectors().rightCols(count);
+}
+
+bool PartialEigenSolver::compute(const SparseMatrix<double> &matrix, int count, const MatrixXd &start)
+{
+    TRACE_SCOPE("PartialEigenSolver::compute");
+
+    const int n = matrix.rows();
+    count = std::min(count, n);
+    // a few guard vectors speed up convergence of the wanted ones
+    const int blockSize = std::min(n, count + std::max(2, count / 2));
+
+    m_iterations = 0;
+    m_basis.resize(0, 0);
+
+    // the iteration basis would be about as large as the matrix itself
+    if (3 * blockSize >= n) {
+        computeDense(matrix, count);
+        return true;
+    }
+
+    // deterministic random fill, so repeated solves give the same vectors
+    std::mt19937 gen(5489u);
+    std::uniform_real_distribution<double> dist(-1., 1.);
+    MatrixXd x(n, 0);
+    if (start.rows() == n) {
+        x = start.leftCols(std::min<int>(start.cols(), blockSize));
+        orthonormalize(x, 0);
+    }
+    while (x.cols() < blockSize) {
+        const int filled = x.cols();
+        x.conservativeResize(NoChange, blockSize);
+        for (int col = filled; col < blockSize; col++) {
+            for (int row = 0; row < n; row++) {
+                x(row, col) = dist(gen);
+            }
+        }
+        orthonormalize(x, filled);
+        if (x.cols() == filled) {
+            return false;
+        }
+    }
+
+    MatrixXd ax = matrix * x;
+    MatrixXd p(n, 0);
+    VectorXd theta;
+
+    // Rayleigh-Ritz on the start block
+    {
+        MatrixXd gram = x.transpose() * ax;
+        SelfAdjointEigenSolver<MatrixXd> small(0.5 * (gram + gram.transpose()));
+        x = x * small.eigenvectors();
+        ax = ax * small.eigenvectors();
+        theta = small.eigenvalues();
+    }
+
+    for (; m_iterations < m_maxIterations; m_iterations++) {
+        const MatrixXd r = ax - x * theta.asDiagonal();
+
+        // converged columns are soft locked, only the others get new directions
+        std::vector<int> active;
+        bool converged = true;
+        for (int col = 0; col < blockSize; col++) {
+            if (r.col(col).norm() > m_tolerance * std::max(1., std::abs(theta(col)))) {
+                active.push_back(col);
+                converged = converged && col < blockSize - count;
+            }
+        }
+        if (converged) {
+            m_eVals = theta.tail(count);
+            m_eVcts = x.rightCols(count);
+            m_basis = x;
+            TRACE_COUNTER("eigensolver iterations", m_iterations);
+            return true;
+        }
+
+        const int activeCount = active.size();
+        const int directions = p.cols() ? 2 * activeCount : activeCount;
+        MatrixXd s(n, blockSize + directions);
+        s.leftCols(blockSize) = x;
+        for (int i = 0; i < activeCount; i++) {
+            s.col(blockSize + i) = r.col(active[i]);
+            if (p.cols()) {
+                s.col(blockSize + activeCount + i) = p.col(active[i]);
+            }
+        }
+        orthonormalize(s, blockSize);
+
+        const int rest = s.cols() - blockSize;
+        MatrixXd as(n, s.cols());
+        as.leftCols(blockSize) = ax;
+        as.rightCols(rest) = matrix * s.rightCols(rest);
+
+        MatrixXd gram = s.transpose() * as;
+        SelfAdjointEigenSolver<MatrixXd> small(0.5 * (gram + gram.transpose()));
+        if (small.info() != Success) {
+            return false;
+        }
+
+        const MatrixXd c = small.eigenvectors().rightCols(blockSize);
+        theta = small.eigenvalues().tail(blockSize);
+
+        // new search direction is the part of the update outside the old block
+        p = s.rightCols(rest) * c.bottomRows(rest);
+        x = s * c;
+        ax = as * c;
+    }
+    return false;
+}
@@ -0,0 +1,71 @@
+/*********************************************************************
+Hypersimplex Representer
+Copyright (C) 2017 Roman Gilg
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#ifndef EIGENSOLVER_H
+#define EIGENSOLVER_H
+
+#include <eigen3/Eigen/Dense>
+#include <eigen3/Eigen/Sparse>
+
+/*
+ * Computes only the largest eigenpairs of a sparse symmetric matrix.
+ *
+ * Uses a locally optimal block preconditioned conjugate gradient (LOBPCG)
+ * iteration without preconditioner, so every step costs a few sparse
+ * products with a thin block instead of a full dense decomposition.
+ * Results are sorted ascending like in Eigen::SelfAdjointEigenSolver.
+ */
+class PartialEigenSolver {
+public:
+    PartialEigenSolver(int maxIterations = 1000, double tolerance = 1e-8);
+
+    /*
+     * Returns false if the iteration did not converge. A 'start' block, like
+     * the basis() of a solve for a slightly different matrix, saves most of
+     * the iterations.
+     */
+    bool compute(const Eigen::SparseMatrix<double> &matrix, int count,
+                 const Eigen::MatrixXd &start = Eigen::MatrixXd());
+
+    const Eigen::VectorXd &eigenvalues() const {
+        return m_eVals;
+    }
+    const Eigen::MatrixXd &eigenvectors() const {
+        return m_eVcts;
+    }
+    int iterations() const {
+        return m_iterations;
+    }
+    // whole iteration block of the last solve, empty if it was solved densely
+    const Eigen::MatrixXd &basis() const {
+        return m_basis;
+    }
+
+private:
+    void computeDense(const Eigen::SparseMatrix<double> &matrix, int count);
+
+    int m_maxIterations;
+    double m_tolerance;
+    int m_iterations = 0;
+
+    Eigen::VectorXd m_eVals;
+    Eigen::MatrixXd m_eVcts;
+    Eigen::MatrixXd m_basis;
+};
+
+#endif // EIGENSOLVER_H
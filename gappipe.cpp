@@ -0,0 +1,207 @@
+/*********************************************************************
+Hypersimplex Representer
+Copyright (C) 2017 Roman Gilg
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#include "gappipe.h"
+
+#include <algorithm>
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <QDebug>
+
+static const std::string s_sentinel = "@@hypersimplex-gap-eval-end@@";
+static const std::size_t s_readBlockSize = 1 << 16;
+
+GapPipe::GapPipe()
+    : m_terminated(false)
+{
+    int pipeStdIn[2];
+    int pipeStdOut[2];
+    if (pipe(pipeStdIn) || pipe(pipeStdOut)) {
+        qDebug() << "Critical pipe error" << errno;
+        return;
+    }
+
+    m_pid = fork();
+
+    if (m_pid == 0) {
+        // child
+
+      dup2(pipeStdIn[0], STDIN_FILENO);
+      dup2(pipeStdOut[1], STDOUT_FILENO);
+
+      close(pipeStdIn[0]);
+      close(pipeStdOut[1]);
+      close(pipeStdIn[1]);
+      close(pipeStdOut[0]);
+
+      // long lines, so GAP breaks its output as rarely as possible
+      std::string lineLength = std::to_string(4096);
+      int childRet = execlp("gap", "gap", "-q", "-m", "64M", "-x", lineLength.c_str(), (char*) NULL);
+
+      qDebug() << "Critical fork error" << childRet;
+      exit(childRet);
+    }
+
+    // parent
+    close(pipeStdIn[0]);
+    close(pipeStdOut[1]);
+
+    m_readPipe = pipeStdOut[0];
+    m_writePipe = pipeStdIn[1];
+
+    if (m_pid < 0) {
+        qDebug() << "Critical fork error" << errno;
+        close(m_readPipe);
+        close(m_writePipe);
+    }
+}
+
+GapPipe::~GapPipe()
+{
+    if (!isValid()) {
+        return;
+    }
+    if (!m_terminated) {
+        writeAll("quit;\n");
+    }
+    close(m_writePipe);
+    close(m_readPipe);
+    waitpid(m_pid, nullptr, 0);
+}
+
+void GapPipe::terminate()
+{
+    if (!isValid() || m_terminated.exchange(true)) {
+        return;
+    }
+    kill(m_pid, SIGKILL);
+}
+
+/*
+ * Writing to a dead GAP must fail with EPIPE instead of killing the
+ * application. SIGPIPE is blocked for the calling thread only, a signal
+ * raised by the write is discarded before the mask is restored.
+ */
+bool GapPipe::writeAll(const std::string &data)
+{
+    sigset_t pipeSet;
+    sigset_t oldSet;
+    sigset_t pendingSet;
+    sigemptyset(&pipeSet);
+    sigaddset(&pipeSet, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipeSet, &oldSet);
+    sigpending(&pendingSet);
+    const bool wasPending = sigismember(&pendingSet, SIGPIPE);
+
+    const char *ptr = data.c_str();
+    std::size_t left = data.size();
+    bool ok = true;
+
+    while (left > 0) {
+        ssize_t written = write(m_writePipe, ptr, left);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ok = false;
+            break;
+        }
+        ptr += written;
+        left -= written;
+    }
+
+    if (!ok && errno == EPIPE && !wasPending) {
+        const timespec noWait = {0, 0};
+        while (sigtimedwait(&pipeSet, nullptr, &noWait) < 0 && errno == EINTR) {}
+    }
+    pthread_sigmask(SIG_SETMASK, &oldSet, nullptr);
+    return ok;
+}
+
+bool GapPipe::eval(const std::string &cmd, const Sink &sink)
+{
+    if (!isValid() || m_terminated) {
+        return false;
+    }
+    if (!writeAll(cmd + "Print(\"\\n" + s_sentinel + "\\n\");\n")) {
+        return false;
+    }
+
+    char block[s_readBlockSize];
+    m_pending.clear();
+
+    while (true) {
+        ssize_t count = read(m_readPipe, block, s_readBlockSize);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            // GAP is gone
+            return false;
+        }
+        if (m_skipNewline) {
+            // line break behind the sentinel of the previous command
+            m_skipNewline = false;
+            if (block[0] == '\n') {
+                if (count == 1) {
+                    continue;
+                }
+                std::copy(block + 1, block + count, block);
+                count--;
+            }
+        }
+
+        // only the tail of the previous data can contain the start of the sentinel
+        const std::size_t searchFrom = m_pending.size() < s_sentinel.size() ? 0 : m_pending.size() - s_sentinel.size();
+        m_pending.append(block, count);
+
+        const std::size_t pos = m_pending.find(s_sentinel, searchFrom);
+        if (pos != std::string::npos) {
+            // drop the line break printed in front of the sentinel
+            const std::size_t end = pos > 0 && m_pending[pos - 1] == '\n' ? pos - 1 : pos;
+            sink(m_pending.data(), end);
+            m_skipNewline = pos + s_sentinel.size() == m_pending.size();
+            m_pending.clear();
+            return true;
+        }
+
+        // hand out everything which can't be part of the sentinel anymore
+        if (m_pending.size() > s_sentinel.size()) {
+            const std::size_t ready = m_pending.size() - s_sentinel.size();
+            sink(m_pending.data(), ready);
+            m_pending.erase(0, ready);
+        }
+    }
+}
+
+std::string GapPipe::eval(const std::string &cmd)
+{
+    std::string ret;
+    eval(cmd, [&ret](const char *data, std::size_t size) {
+        ret.append(data, size);
+    });
+    ret.erase(std::remove(ret.begin(), ret.end(), '\n'), ret.end());
+    return ret;
+}
@@ -0,0 +1,70 @@
+/*********************************************************************
+Hypersimplex Representer
+Copyright (C) 2017 Roman Gilg
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#ifndef GAPPIPE_H
+#define GAPPIPE_H
+
+#include <atomic>
+#include <functional>
+#include <string>
+
+#include <sys/types.h>
+
+/*
+ * Connection to a GAP child process.
+ *
+ * Every command is followed by printing a sentinel line, such that the end
+ * of its output is known without relying on the output format. The output
+ * is read in large blocks and can be streamed to a consumer while GAP
+ * still writes it.
+ */
+class GapPipe {
+public:
+    typedef std::function<void(const char *data, std::size_t size)> Sink;
+
+    GapPipe();
+    ~GapPipe();
+
+    bool isValid() const {
+        return m_pid > 0;
+    }
+
+    /*
+     * Kills GAP, a running eval() returns false. Can be called from
+     * another thread than the one evaluating.
+     */
+    void terminate();
+
+    // returns the complete output of 'cmd' with line breaks removed
+    std::string eval(const std::string &cmd);
+    // hands the output of 'cmd' to 'sink' in chunks as it arrives
+    bool eval(const std::string &cmd, const Sink &sink);
+
+private:
+    bool writeAll(const std::string &data);
+
+    pid_t m_pid = -1;
+    std::atomic<bool> m_terminated;
+    int m_writePipe = -1;
+    int m_readPipe = -1;
+
+    std::string m_pending;
+    bool m_skipNewline = false;
+};
+
+#endif // GAPPIPE_H
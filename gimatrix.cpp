@@ -17,17 +17,23 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *********************************************************************/
 
 #include "gimatrix.h"
+#include "eigensolver.h"
 #include "hypersimplex.h"
 #include "schlegel.h"
+#include "symmetryblocks.h"
+#include "trace.h"
 
 #include <algorithm>
 #include <eigen3/Eigen/Eigenvalues>
 
 #include <QDebug>
+#include <QThread>
+#include <QtConcurrent/QtConcurrentMap>
 
 #include <cmath>
-#include <iostream>
 
+// a failed partial or block solve falls back to the dense solve only up to this vertex count
+static const int s_denseFallbackMaxDim = 4000;
 
 GiMatrix::GiMatrix(Hypersimplex *hypers, VtxTrnsSubgroup *group)
     : m_dim(hypers->vertexCount()),
@@ -41,22 +47,29 @@ GiMatrix::GiMatrix(Hypersimplex *hypers, VtxTrnsSubgroup *group)
 
 void GiMatrix::init()
 {
-    m_matrix.resize(m_dim, m_dim);
-    m_multMatrix.resize(m_dim, m_dim);
-    m_eecIndexMatrix.resize(m_dim, m_dim);
-
-
-    // diagonal is always zero
-    for (int i = 0; i < m_dim; i++) {
-        m_matrix(i, i) = 0;
-        m_eecIndexMatrix(i, i) = 0;
-    }
-
     calculateEecIndexMatrix();
     setVars(std::vector<double>());
 }
 
 bool GiMatrix::setVars(const std::vector<double> set)
+{
+    if (!assembleVars(set)) {
+        return false;
+    }
+    calcNullspaceRepr();
+    return true;
+}
+
+bool GiMatrix::assembleVars(const std::vector<double> &set)
+{
+    if (!assignVars(set)) {
+        return false;
+    }
+    updateMatrixValues();
+    return true;
+}
+
+bool GiMatrix::assignVars(const std::vector<double> &set)
 {
     std::vector<double> varsTmp, multVarsTmp;
     // first entry is always zero for more efficient queries
@@ -75,8 +88,6 @@ bool GiMatrix::setVars(const std::vector<double> set)
         m_multVars.clear();
         m_vars = varsTmp;
         m_multVars = multVarsTmp;
-
-        calculateMatrix();
         return true;
     }
 
@@ -103,54 +114,273 @@ bool GiMatrix::setVars(const std::vector<double> set)
     }
     m_vars = varsTmp;
     m_multVars = multVarsTmp;
-
-    calculateMatrix();
     return true;
 }
 
-void GiMatrix::calculateEecIndexMatrix()
+std::vector<std::vector<double> > GiMatrix::getSimplexGrid(int steps) const
+{
+    std::vector<std::vector<double> > grid;
+    const int n = m_mult.size();
+    if (!n || steps <= 0) {
+        return grid;
+    }
+
+    // walk through all compositions of 'steps' into n parts
+    std::vector<int> parts(n, 0);
+    parts[0] = steps;
+    while (true) {
+        std::vector<double> vars(n);
+        for (int i = 0; i < n; i++) {
+            vars[i] = parts[i] / ((double)steps * m_mult[i]);
+        }
+        grid.push_back(vars);
+
+        if (parts[n - 1] == steps) {
+            break;
+        }
+        int j = n - 2;
+        while (!parts[j]) {
+            j--;
+        }
+        const int last = parts[n - 1];
+        parts[n - 1] = 0;
+        parts[j]--;
+        parts[j + 1] = last + 1;
+    }
+    return grid;
+}
+
+std::vector<GiSweepPoint> GiMatrix::sweepVars(const std::vector<std::vector<double> > &points,
+                                              bool keepRepr) const
 {
-    for (int row = 0; row < m_dim; row++) {
-        for (int col = 0; col < row; col++) {
-            const auto edge = Edge(col, row);
+    TRACE_SCOPE("GiMatrix::sweepVars");
+
+    std::vector<GiSweepPoint> results(points.size());
+    if (points.empty()) {
+        return results;
+    }
+
+    // built lazily, which must not happen in the workers
+    GiMatrix prepared(*this);
+    if (m_eigenSolverMode == 3 && !prepared.m_symmetryBlocks) {
+        prepared.m_symmetryBlocks = m_hypers->getSymmetryBlocks(m_group);
+    }
 
-            int foundIndex = 0;
-            int eecIndex = 1;
-            for (auto eec : m_group->m_edgeEquivClasses) {
-                if (eec->has(edge)) {
-                    foundIndex = eecIndex;
-                    break;
+    // contiguous chunks, so that neighbouring grid points warm start each other
+    const int pointCount = points.size();
+    const int chunkCount = std::min(pointCount, 4 * std::max(1, QThread::idealThreadCount()));
+    std::vector<std::pair<int, int> > chunks;
+    for (int c = 0; c < chunkCount; c++) {
+        chunks.push_back(std::make_pair(c * pointCount / chunkCount, (c + 1) * pointCount / chunkCount));
+    }
+
+    QtConcurrent::blockingMap(chunks, [&prepared, &points, &results, keepRepr](const std::pair<int, int> &chunk) {
+        GiMatrix worker(prepared);
+
+        for (int i = chunk.first; i < chunk.second; i++) {
+            if (!worker.assembleVars(points[i])) {
+                continue;
+            }
+
+            VectorXd eVals;
+            MatrixXd eVcts;
+            if (!worker.calcEigenpairs(eVals, eVcts)) {
+                continue;
+            }
+            const MatrixXd nullSpRepr = worker.getMaxDimensionalNullspBasis(eVals, eVcts);
+
+            GiSweepPoint &result = results[i];
+            result.valid = true;
+            result.nullspaceDim = nullSpRepr.rows();
+            if (keepRepr) {
+                for (int v = 0; v < nullSpRepr.cols(); v++) {
+                    result.nullspaceRepr.push_back(nullSpRepr.col(v));
                 }
-                eecIndex++;
             }
-            m_eecIndexMatrix(row, col) = foundIndex;
-            m_eecIndexMatrix(col, row) = foundIndex;
         }
+    });
+    return results;
+}
+
+void GiMatrix::calculateEecIndexMatrix()
+{
+    TRACE_SCOPE("GiMatrix::calculateEecIndexMatrix");
+
+    const Adjacency &adjacency = m_hypers->adjacency();
+    const std::vector<int> &edgeClasses = m_group->m_edgeClasses;
+
+    // diagonal is always zero, so only the edges get an entry
+    std::vector<Triplet<double> > entries;
+    entries.reserve(2 * adjacency.edgeCount());
+
+    for (int id = 0; id < adjacency.edgeCount(); id++) {
+        const Edge &edge = adjacency.edge(id);
+        const double eecIndex = edgeClasses[id] + 1;
+        entries.push_back(Triplet<double>(edge.v, edge.w, eecIndex));
+        entries.push_back(Triplet<double>(edge.w, edge.v, eecIndex));
+    }
+
+    // store the EEC indices in the value slots first, to get them in storage order
+    m_matrix.resize(m_dim, m_dim);
+    m_matrix.setFromTriplets(entries.begin(), entries.end());
+    m_matrix.makeCompressed();
+
+    const int nonZeros = m_matrix.nonZeros();
+    const double *values = m_matrix.valuePtr();
+    m_eecIndices.resize(nonZeros);
+    for (int i = 0; i < nonZeros; i++) {
+        m_eecIndices[i] = (int)values[i];
+    }
+    m_multMatrix = m_matrix;
+}
+
+void GiMatrix::updateMatrixValues()
+{
+    TRACE_SCOPE("GiMatrix::updateMatrixValues");
+
+    const int nonZeros = m_eecIndices.size();
+    double *values = m_matrix.valuePtr();
+    double *multValues = m_multMatrix.valuePtr();
+
+    for (int i = 0; i < nonZeros; i++) {
+        values[i] = m_vars[m_eecIndices[i]];
+        multValues[i] = m_multVars[m_eecIndices[i]];
+    }
+}
+
+bool GiMatrix::calcEigenpairs(VectorXd &eVals, MatrixXd &eVcts)
+{
+    TRACE_SCOPE("GiMatrix::calcEigenpairs");
+
+    m_eigenspaceDims.clear();
+
+    if (m_eigenSolverMode == 3) {
+        if (calcBlockEigenpairs(eVals, eVcts)) {
+            return true;
+        }
+        qDebug() << "No symmetry adapted blocks for" << m_group->m_gapName.c_str();
+    } else if (m_eigenSolverMode == 2) {
+        // top eigenvalue, the d - 1 below it and some more to recognize clusters
+        // start from the previous eigenvectors, a slider step only changes them a bit
+        PartialEigenSolver solver;
+        if (solver.compute(m_matrix, m_hypers->d() + 2, m_warmStart)) {
+            m_warmStart = solver.basis();
+            eVals = solver.eigenvalues();
+            eVcts = solver.eigenvectors();
+            return true;
+        }
+        m_warmStart.resize(0, 0);
+        qDebug() << "Partial eigensolver did not converge after" << solver.iterations() << "iterations";
+    }
+
+    if (m_eigenSolverMode >= 2) {
+        if (m_dim > s_denseFallbackMaxDim) {
+            qDebug() << "Error: No full solve fallback for" << m_dim << "vertices, the dense matrix is too large.";
+            return false;
+        }
+        qDebug() << "Falling back to full solve.";
+    }
+
+    const MatrixXd denseMatrix(m_matrix);
+    SelfAdjointEigenSolver<MatrixXd> eigensolver(denseMatrix);
+    if (eigensolver.info() != Success) {
+        return false;
     }
+    eVals = eigensolver.eigenvalues();
+    eVcts = eigensolver.eigenvectors();
+    return true;
 }
 
-void GiMatrix::calculateMatrix()
+/*
+ * Solves the matrix in every isotypic component of the subgroup. The block
+ * eigenvalues come in runs of the component's irreducible dimension, each
+ * run is one eigenspace.
+ */
+bool GiMatrix::calcBlockEigenpairs(VectorXd &eVals, MatrixXd &eVcts)
 {
-    for (int row = 0; row < m_dim; row++) {
-        for (int col = 0; col < row; col++) {
-            auto eecIndex = m_eecIndexMatrix(row, col);
-            auto val = m_vars[eecIndex];
-            auto multVal = m_multVars[eecIndex];
-            m_matrix(row, col) = val;
-            m_matrix(col, row) = val;
-            m_multMatrix(row, col) = multVal;
-            m_multMatrix(col, row) = multVal;
+    TRACE_SCOPE("GiMatrix::calcBlockEigenpairs");
+
+    if (!m_symmetryBlocks) {
+        m_symmetryBlocks = m_hypers->getSymmetryBlocks(m_group);
+    }
+    const SymmetryBlocks &symBlocks = *m_symmetryBlocks;
+    if (!symBlocks.isValid()) {
+        return false;
+    }
+
+    struct Eigenspace {
+        double value;
+        MatrixXd vectors;
+    };
+    std::vector<Eigenspace> spaces;
+
+    for (auto &block : symBlocks.blocks()) {
+        const MatrixXd &basis = block.basis;
+        const MatrixXd reduced = basis.transpose() * (m_matrix * basis);
+
+        SelfAdjointEigenSolver<MatrixXd> solver(0.5 * (reduced + reduced.transpose()));
+        if (solver.info() != Success) {
+            return false;
+        }
+        for (int i = 0; i < basis.cols(); i += block.irrepDim) {
+            Eigenspace space;
+            space.value = solver.eigenvalues().segment(i, block.irrepDim).mean();
+            space.vectors = basis * solver.eigenvectors().middleCols(i, block.irrepDim);
+            spaces.push_back(space);
         }
     }
-    calcNullspaceRepr();
+    std::stable_sort(spaces.begin(), spaces.end(),
+                     [](const Eigenspace &a, const Eigenspace &b) { return a.value < b.value; });
+
+    eVals.resize(m_dim);
+    eVcts.resize(m_dim, m_dim);
+    int col = 0;
+    for (auto &space : spaces) {
+        const int dim = space.vectors.cols();
+        eVals.segment(col, dim).setConstant(space.value);
+        eVcts.middleCols(col, dim) = space.vectors;
+        m_eigenspaceDims.push_back(dim);
+        col += dim;
+    }
+    return true;
+}
+
+/*
+ * The exactly known eigenspaces below the top one as (start, dimension),
+ * from high to low. Numerically equal eigenvalues count as one space.
+ */
+std::vector<std::pair<int, int> > GiMatrix::getLowerEigenspaces(const VectorXd &eVals) const
+{
+    std::vector<std::pair<int, int> > spaces;
+    int end = eVals.rows() - m_eigenspaceDims.back();
+
+    for (int space = m_eigenspaceDims.size() - 2; space >= 0; ) {
+        int start = end - m_eigenspaceDims[space--];
+        while (space >= 0 && std::abs(eVals(start - 1) - eVals(end - 1)) < 1e-9) {
+            start -= m_eigenspaceDims[space--];
+        }
+        spaces.push_back(std::make_pair(start, end - start));
+        end = start;
+    }
+    return spaces;
 }
 
 MatrixXd GiMatrix::getMaxDimensionalNullspBasis(const VectorXd &eVals, const MatrixXd &eVcts)
 {
     int nullSpDim = m_hypers->d() - 1;
+    // a partial solve only knows the top of the spectrum
+    const bool partial = eVals.rows() < m_dim;
+
+    if (!m_eigenspaceDims.empty() && m_selEigenvectMode != 1) {
+        for (auto &space : getLowerEigenspaces(eVals)) {
+            if (m_selEigenvectMode == 2 || space.second == nullSpDim) {
+                return eVcts.block(0, space.first, m_dim, space.second).transpose();
+            }
+        }
+    }
 
     if (m_selEigenvectMode == 0) {
-        auto nearIndices = [nullSpDim, &eVals, &eVcts](double epsilon) {
+        auto nearIndices = [nullSpDim, partial, &eVals, &eVcts](double epsilon) {
             std::vector<int> hits;
             for (int i = eVals.rows() - 2; i >= 0; i--) {
                 hits = std::vector<int>();
@@ -159,7 +389,8 @@ MatrixXd GiMatrix::getMaxDimensionalNullspBasis(const VectorXd &eVals, const Mat
                         hits.push_back(j);
                     }
                 }
-                if (hits.size() == nullSpDim) {
+                // a cluster at the lower end might continue outside of the computed ones
+                if (hits.size() == nullSpDim && (!partial || hits[nullSpDim - 1] > 0)) {
                     return hits[nullSpDim - 1];
                 }
             }
@@ -180,50 +411,36 @@ MatrixXd GiMatrix::getMaxDimensionalNullspBasis(const VectorXd &eVals, const Mat
     // highest indices after the first one
     int count = nullSpDim;
     if (m_selEigenvectMode == 2) {
-        // only for same eigenvalue
+        // only for same eigenvalue, iterative results are less exact
+        const double sameEpsilon = partial ? 1e-8 : std::numeric_limits<double>::epsilon();
         count = 1;
         double ev = eVals(eVals.rows() - 2);
         for (int i = eVals.rows() - 3; i >= 0; i--) {
-            if (std::abs(eVals(i) - ev) < std::numeric_limits<double>::epsilon()) {
+            if (std::abs(eVals(i) - ev) < sameEpsilon) {
                 count++;
             } else {
                 break;
             }
         }
     }
-    return eVcts.block(0, m_dim - 1 - count, m_dim, count).transpose();
+    count = std::min(count, (int)eVals.rows() - 1);
+    return eVcts.block(0, eVals.rows() - 1 - count, m_dim, count).transpose();
 }
 
 void GiMatrix::calcNullspaceRepr()
 {
-    qDebug() << "----------------";
-    qDebug() << "----------------";
-
-    qDebug() << "Edge equivalence classes for" << m_group->m_gapName.c_str() << ":";
-    std::cout << m_eecIndexMatrix  << std::endl;
-    qDebug() << "Doubly stochastic matrix:";
-    std::cout << m_matrix  << std::endl;
+    TRACE_SCOPE("GiMatrix::calcNullspaceRepr");
 
     m_nullSpReprList.clear();
 
-    SelfAdjointEigenSolver<MatrixXd> eigensolver(m_matrix);
-    if (eigensolver.info() != Success) {
+    VectorXd eVals;
+    MatrixXd eVcts;
+    if (!calcEigenpairs(eVals, eVcts)) {
         return;
     }
 
-    VectorXd eVals = eigensolver.eigenvalues();
-    MatrixXd eVcts = eigensolver.eigenvectors();
-
-    qDebug() << "Eigenvalues:";
-    std::cout << eVals.transpose() << std::endl;
-
-    qDebug() << "Eigenvectors:";
-    std::cout << eVcts  << std::endl;
-
-    qDebug() << "----------------";
-    qDebug() << "Null Space Representation:";
     MatrixXd nullSpRepr = getMaxDimensionalNullspBasis(eVals, eVcts);
-    std::cout << nullSpRepr  << std::endl;;
+    TRACE_COUNTER("nullspace dimension", nullSpRepr.rows());
     m_nullSpRepr = nullSpRepr;
 
     std::vector<VectorXd> nullSpReprList;
@@ -234,8 +451,41 @@ void GiMatrix::calcNullspaceRepr()
     m_nullSpReprList = nullSpReprList;
 }
 
+std::vector<VectorXd> GiMatrix::getConjugateNullspaceRepr(int conjugate) const
+{
+    const std::vector<Permutation> &conjugators = m_hypers->getConjugators(m_group);
+    if (conjugate < 0 || conjugate >= (int)conjugators.size()) {
+        return std::vector<VectorXd>();
+    }
+    const std::vector<int> relabelling = m_hypers->getVertexRelabelling(conjugators[conjugate]);
+
+    std::vector<VectorXd> repr(m_nullSpReprList.size());
+    for (std::size_t v = 0; v < m_nullSpReprList.size(); v++) {
+        repr[relabelling[v]] = m_nullSpReprList[v];
+    }
+    return repr;
+}
+
 std::vector<VectorXd> GiMatrix::getSchlegelDiagram(int projFacet, bool projToLargerFacet, int &error)
 {
     Schlegel s(m_hypers, projFacet, projToLargerFacet, m_nullSpRepr);
     return s.getDiagram(error);
 }
+
+std::size_t GiMatrix::memoryUsage() const
+{
+    // values and inner indices of both sparse matrices
+    const std::size_t nonZeros = m_matrix.nonZeros() + m_multMatrix.nonZeros();
+    std::size_t bytes = nonZeros * (sizeof(double) + sizeof(int));
+    bytes += (m_matrix.outerSize() + m_multMatrix.outerSize() + 2) * sizeof(int);
+    bytes += m_eecIndices.size() * sizeof(int);
+
+    bytes += (m_warmStart.size() + m_nullSpRepr.size()) * sizeof(double);
+    for (auto &v : m_nullSpReprList) {
+        bytes += v.size() * sizeof(double);
+    }
+    if (m_symmetryBlocks) {
+        bytes += m_symmetryBlocks->memoryUsage();
+    }
+    return bytes;
+}
@@ -19,19 +19,33 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef GIMATRIX_H
 #define GIMATRIX_H
 
+#include <memory>
 #include <vector>
 #include <eigen3/Eigen/Dense>
+#include <eigen3/Eigen/Sparse>
 
 class Hypersimplex;
+class SymmetryBlocks;
 class VtxTrnsSubgroup;
 
 using namespace Eigen;
 
+// Result of one variable set in a batch evaluation
+struct GiSweepPoint {
+    bool valid = false;
+    // number of eigenvectors spanning the representation
+    int nullspaceDim = 0;
+    std::vector<VectorXd> nullspaceRepr;
+};
+
 // Group invariant matrix with vanishing diagonal
 class GiMatrix {
 public:
     GiMatrix(Hypersimplex *hypers, VtxTrnsSubgroup *group);
+    // builds the sparse pattern and solves for the default variables
     void init();
+    // only builds the sparse pattern, setVars has to follow
+    void calculateEecIndexMatrix();
 
     std::vector<double> getVars() const {
         return std::vector<double>(m_vars.begin() + 1, m_vars.end());
@@ -41,15 +55,38 @@ public:
     }
 
     bool setVars(const std::vector<double> set);
+    // first stage of setVars, writes the variables into the matrix, calcNullspaceRepr solves it
+    bool assembleVars(const std::vector<double> &set);
+
+    /*
+     * Variable sets with sum(mult_i * x_i) = 1 on a regular grid of the
+     * simplex, every weight mult_i * x_i being a multiple of 1 / steps.
+     */
+    std::vector<std::vector<double> > getSimplexGrid(int steps) const;
+    /*
+     * Evaluates many variable sets in parallel. This matrix is not changed,
+     * every worker starts from a copy with its sparse pattern and solver
+     * settings. Invalid sets give an invalid point.
+     */
+    std::vector<GiSweepPoint> sweepVars(const std::vector<std::vector<double> > &points,
+                                        bool keepRepr = true) const;
 
     void calcNullspaceRepr();
     std::vector<VectorXd> getNullspaceRepr() const {
         return m_nullSpReprList;
     }
 
+    // representation of a conjugate of the subgroup, see Hypersimplex::getConjugators,
+    // by relabelling the vertices
+    std::vector<VectorXd> getConjugateNullspaceRepr(int conjugate) const;
+
     std::vector<VectorXd> getSchlegelDiagram(int projFacet, bool projToLargerFacet, int &error);
 
-    MatrixXd getMatrix() const {
+    Hypersimplex *hypersimplex() const {
+        return m_hypers;
+    }
+
+    const SparseMatrix<double> &getMatrix() const {
         return m_matrix;
     }
 
@@ -57,28 +94,56 @@ public:
         m_selEigenvectMode = mode;
     }
 
+    /*
+     * 0, 1: full solve, 2: partial solve of the highest eigenvalues,
+     * 3: full solve in the symmetry adapted blocks of the subgroup
+     */
+    void setEigenSolverMode(int mode) {
+        m_eigenSolverMode = mode;
+    }
+
+    // approximate heap memory held by this matrix, in bytes, with its symmetry blocks
+    std::size_t memoryUsage() const;
+
+    // dimensions of the eigenspaces in ascending order, if known exactly
+    std::vector<int> getEigenspaceDims() const {
+        return m_eigenspaceDims;
+    }
+
 private:
-    void calculateEecIndexMatrix();
-    void calculateMatrix();
+    bool assignVars(const std::vector<double> &set);
+    void updateMatrixValues();
+    bool calcEigenpairs(VectorXd &eVals, MatrixXd &eVcts);
+    bool calcBlockEigenpairs(VectorXd &eVals, MatrixXd &eVcts);
+    std::vector<std::pair<int, int> > getLowerEigenspaces(const VectorXd &eVals) const;
     MatrixXd getMaxDimensionalNullspBasis(const VectorXd &eVals, const MatrixXd &eVcts);
 
     Hypersimplex *m_hypers;
     VtxTrnsSubgroup *m_group;
 
-    MatrixXd m_matrix;          // Matrix<double, Dynamic, Dynamic>
-    MatrixXd m_multMatrix;      // Matrix<double, Dynamic, Dynamic>
-    MatrixXi m_eecIndexMatrix;  // Matrix<double, Dynamic, Dynamic>
+    // only edges have non-zero entries, both matrices share this pattern
+    SparseMatrix<double> m_matrix;
+    SparseMatrix<double> m_multMatrix;
+    // EEC index (starting at 1) of every non-zero in the storage order of m_matrix
+    std::vector<int> m_eecIndices;
 
     std::vector<int> m_mult;
     std::vector<double> m_vars;
     std::vector<double> m_multVars;
 
+    std::vector<int> m_eigenspaceDims;
+    // shared by the matrices of the subgroup, released with the last one
+    std::shared_ptr<const SymmetryBlocks> m_symmetryBlocks;
+    // iteration block of the last partial solve
+    MatrixXd m_warmStart;
+
     MatrixXd m_nullSpRepr;
     std::vector<VectorXd> m_nullSpReprList;
 
     int m_dim;
 
     int m_selEigenvectMode = 0;
+    int m_eigenSolverMode = 0;
 };
 
 #endif // GIMATRIX_H
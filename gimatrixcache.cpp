@@ -0,0 +1,230 @@
+/*********************************************************************
+Hypersimplex Representer
+Copyright (C) 2017 Roman Gilg
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#include "gimatrixcache.h"
+#include "gimatrix.h"
+#include "hypersimplex.h"
+#include "trace.h"
+
+#include <QtConcurrent/QtConcurrentRun>
+
+GiMatrixCache::GiMatrixCache(Hypersimplex *hypers, int selEigenvectMode, int eigenSolverMode,
+                             std::size_t budget)
+    : m_hypers(hypers),
+      m_subgroupCount(hypers->getVtxTrSubgroupCount()),
+      m_budget(budget),
+      m_selEigenvectMode(selEigenvectMode),
+      m_eigenSolverMode(eigenSolverMode),
+      m_prefetched(m_subgroupCount, false)
+{}
+
+GiMatrixCache::~GiMatrixCache()
+{
+    stop();
+    m_prefetch.waitForFinished();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_built.wait(lock, [this]() {
+        return m_requests == 0;
+    });
+}
+
+void GiMatrixCache::stop()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopped = true;
+    m_built.notify_all();
+}
+
+void GiMatrixCache::setSolverModes(int selEigenvectMode, int eigenSolverMode)
+{
+    int first;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_selEigenvectMode == selEigenvectMode && m_eigenSolverMode == eigenSolverMode) {
+            return;
+        }
+        m_selEigenvectMode = selEigenvectMode;
+        m_eigenSolverMode = eigenSolverMode;
+        m_generation++;
+
+        m_entries.clear();
+        m_entryIndex.clear();
+        m_bytes = 0;
+        m_prefetched.assign(m_subgroupCount, false);
+        first = m_prefetchFirst;
+    }
+    startPrefetch(first);
+}
+
+void GiMatrixCache::startPrefetch(int first)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_prefetchFirst = first;
+    m_prefetchFull = false;
+    if (m_prefetchRunning || m_stopped) {
+        return;
+    }
+    m_prefetchRunning = true;
+    m_prefetch = QtConcurrent::run([this]() {
+        prefetch();
+    });
+}
+
+std::shared_ptr<const GiMatrix> GiMatrixCache::find(int subgroup)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entryIndex.find(subgroup);
+    if (it == m_entryIndex.end()) {
+        return std::shared_ptr<const GiMatrix>();
+    }
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return it->second->matrix;
+}
+
+QFuture<std::shared_ptr<const GiMatrix> > GiMatrixCache::request(int subgroup)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_requests++;
+    }
+    return QtConcurrent::run([this, subgroup]() {
+        std::shared_ptr<const GiMatrix> matrix = acquire(subgroup);
+
+        // the destructor may go on once the lock is released
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_requests--;
+        m_built.notify_all();
+        return matrix;
+    });
+}
+
+std::shared_ptr<const GiMatrix> GiMatrixCache::acquire(int subgroup)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        if (m_stopped) {
+            return std::shared_ptr<const GiMatrix>();
+        }
+        auto it = m_entryIndex.find(subgroup);
+        if (it != m_entryIndex.end()) {
+            m_entries.splice(m_entries.begin(), m_entries, it->second);
+            return it->second->matrix;
+        }
+        if (!m_building.count(subgroup)) {
+            break;
+        }
+        m_built.wait(lock);
+    }
+
+    const int generation = m_generation;
+    const int selEigenvectMode = m_selEigenvectMode;
+    const int eigenSolverMode = m_eigenSolverMode;
+    m_building.insert(subgroup);
+    lock.unlock();
+
+    auto matrix = build(subgroup, selEigenvectMode, eigenSolverMode);
+
+    lock.lock();
+    m_building.erase(subgroup);
+    if (generation == m_generation) {
+        insert(subgroup, matrix);
+    }
+    m_built.notify_all();
+    return matrix;
+}
+
+bool GiMatrixCache::contains(int subgroup) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entryIndex.count(subgroup);
+}
+
+void GiMatrixCache::prefetch()
+{
+    TRACE_SCOPE("GiMatrixCache::prefetch");
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopped && !m_prefetchFull) {
+        const int subgroup = nextPrefetchSubgroup();
+        if (subgroup < 0) {
+            break;
+        }
+        const int generation = m_generation;
+        const int selEigenvectMode = m_selEigenvectMode;
+        const int eigenSolverMode = m_eigenSolverMode;
+        m_prefetched[subgroup] = true;
+        m_building.insert(subgroup);
+        lock.unlock();
+
+        auto matrix = build(subgroup, selEigenvectMode, eigenSolverMode);
+
+        lock.lock();
+        m_building.erase(subgroup);
+        if (generation == m_generation && !insert(subgroup, matrix)) {
+            // prefetching more would only drop matrices prefetched before
+            m_prefetchFull = true;
+        }
+        m_built.notify_all();
+    }
+    m_prefetchRunning = false;
+}
+
+int GiMatrixCache::nextPrefetchSubgroup() const
+{
+    for (int i = 0; i < m_subgroupCount; i++) {
+        const int subgroup = (m_prefetchFirst + i) % m_subgroupCount;
+        if (!m_prefetched[subgroup] && !m_building.count(subgroup)
+                && !m_entryIndex.count(subgroup)) {
+            return subgroup;
+        }
+    }
+    return -1;
+}
+
+std::shared_ptr<const GiMatrix> GiMatrixCache::build(int subgroup, int selEigenvectMode,
+                                                     int eigenSolverMode) const
+{
+    TRACE_SCOPE("GiMatrixCache::build");
+
+    auto matrix = std::make_shared<GiMatrix>(m_hypers->getGiMatrix(subgroup));
+    matrix->setSelEigenvectMode(selEigenvectMode);
+    matrix->setEigenSolverMode(eigenSolverMode);
+    matrix->init();
+    return matrix;
+}
+
+bool GiMatrixCache::insert(int subgroup, const std::shared_ptr<const GiMatrix> &matrix)
+{
+    if (m_entryIndex.count(subgroup)) {
+        return true;
+    }
+    const std::size_t bytes = matrix->memoryUsage();
+    m_entries.push_front(Entry{subgroup, matrix, bytes});
+    m_entryIndex[subgroup] = m_entries.begin();
+    m_bytes += bytes;
+
+    bool fits = true;
+    while (m_bytes > m_budget && m_entries.size() > 1) {
+        m_bytes -= m_entries.back().bytes;
+        m_entryIndex.erase(m_entries.back().subgroup);
+        m_entries.pop_back();
+        fits = false;
+    }
+    return fits;
+}
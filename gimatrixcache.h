@@ -0,0 +1,114 @@
+/*********************************************************************
+Hypersimplex Representer
+Copyright (C) 2017 Roman Gilg
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#ifndef GIMATRIXCACHE_H
+#define GIMATRIXCACHE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include <QFuture>
+
+class GiMatrix;
+class Hypersimplex;
+
+/*
+ * Initialised matrices with the default variables for the vertex transitive
+ * subgroups of a hypersimplex. A background thread builds them in advance,
+ * starting at a given subgroup, until the cache is full. The least recently
+ * used matrices are dropped once the memory budget is exceeded, the most
+ * recent one is always kept.
+ *
+ * Nothing here blocks the caller on a build: missing matrices are requested
+ * as futures, which are built on the thread pool.
+ */
+class GiMatrixCache {
+public:
+    static const std::size_t DefaultBudget = 256 * 1024 * 1024;
+
+    GiMatrixCache(Hypersimplex *hypers, int selEigenvectMode, int eigenSolverMode,
+                  std::size_t budget = DefaultBudget);
+    // waits for the matrices being built, see stop()
+    ~GiMatrixCache();
+
+    // no new builds, pending requests give null; returns right away
+    void stop();
+
+    // drops the cached matrices, new ones are built with these modes
+    void setSolverModes(int selEigenvectMode, int eigenSolverMode);
+
+    void startPrefetch(int first = 0);
+
+    // null if not built yet
+    std::shared_ptr<const GiMatrix> find(int subgroup);
+    // the matrix once built, or null if the cache is stopped before
+    QFuture<std::shared_ptr<const GiMatrix> > request(int subgroup);
+    bool contains(int subgroup) const;
+
+private:
+    struct Entry {
+        int subgroup;
+        std::shared_ptr<const GiMatrix> matrix;
+        std::size_t bytes;
+    };
+
+    void prefetch();
+    // waits for a build by another thread, or builds on the calling one
+    std::shared_ptr<const GiMatrix> acquire(int subgroup);
+    int nextPrefetchSubgroup() const;
+    std::shared_ptr<const GiMatrix> build(int subgroup, int selEigenvectMode, int eigenSolverMode) const;
+    // returns false if the oldest entries had to make room
+    bool insert(int subgroup, const std::shared_ptr<const GiMatrix> &matrix);
+
+    Hypersimplex *m_hypers;
+    int m_subgroupCount;
+    std::size_t m_budget;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_built;
+
+    // most recently used first
+    std::list<Entry> m_entries;
+    std::unordered_map<int, std::list<Entry>::iterator> m_entryIndex;
+    std::size_t m_bytes = 0;
+
+    // being built by any thread
+    std::set<int> m_building;
+    // builds of older generations are dropped
+    int m_generation = 0;
+    int m_selEigenvectMode;
+    int m_eigenSolverMode;
+
+    // every subgroup is prefetched at most once per generation
+    std::vector<bool> m_prefetched;
+    int m_prefetchFirst = 0;
+    bool m_prefetchFull = false;
+    bool m_prefetchRunning = false;
+    bool m_stopped = false;
+    QFuture<void> m_prefetch;
+    // running request() futures
+    int m_requests = 0;
+};
+
+#endif // GIMATRIXCACHE_H
@@ -0,0 +1,319 @@
+/*********************************************************************
+Hypersimplex Representer
+Copyright (C) 2017 Roman Gilg
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#include "groupcache.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char s_magic[4] = {'H', 'S', 'R', 'C'};
+// increase on every change of the file layout or of the cached results
+static const int32_t s_version = 2;
+
+namespace {
+
+class Writer {
+public:
+    void int32(int32_t val) {
+        m_data.append(reinterpret_cast<const char *>(&val), sizeof(val));
+    }
+    void ints(const std::vector<int> &vals) {
+        int32(vals.size());
+        for (auto v : vals) {
+            int32(v);
+        }
+    }
+    void string(const std::string &str) {
+        int32(str.size());
+        m_data.append(str);
+    }
+    void raw(const char *data, std::size_t size) {
+        m_data.append(data, size);
+    }
+    const std::string &data() const {
+        return m_data;
+    }
+
+private:
+    std::string m_data;
+};
+
+class Reader {
+public:
+    Reader(const char *data, std::size_t size)
+        : m_ptr(data),
+          m_end(data + size)
+    {}
+
+    bool ok() const {
+        return m_ok;
+    }
+    int32_t int32() {
+        int32_t val = 0;
+        if (!take(sizeof(val))) {
+            return 0;
+        }
+        std::memcpy(&val, m_ptr - sizeof(val), sizeof(val));
+        return val;
+    }
+    std::vector<int> ints() {
+        const int32_t count = int32();
+        std::vector<int> ret;
+        if (count < 0 || !canTake((std::size_t)count * sizeof(int32_t))) {
+            m_ok = false;
+            return ret;
+        }
+        ret.resize(count);
+        for (auto &v : ret) {
+            v = int32();
+        }
+        return ret;
+    }
+    std::string string() {
+        const int32_t size = int32();
+        if (size < 0 || !take(size)) {
+            m_ok = false;
+            return std::string();
+        }
+        return std::string(m_ptr - size, size);
+    }
+    bool raw(const char *expected, std::size_t size) {
+        return take(size) && !std::memcmp(m_ptr - size, expected, size);
+    }
+
+private:
+    bool canTake(std::size_t size) const {
+        return m_ok && (std::size_t)(m_end - m_ptr) >= size;
+    }
+    bool take(std::size_t size) {
+        if (!canTake(size)) {
+            m_ok = false;
+            return false;
+        }
+        m_ptr += size;
+        return true;
+    }
+
+    const char *m_ptr;
+    const char *m_end;
+    bool m_ok = true;
+};
+
+// every point in [0, size) exactly once
+bool isPermutation(const std::vector<int> &perm)
+{
+    std::vector<bool> seen(perm.size(), false);
+    for (auto p : perm) {
+        if (p < 0 || p >= (int)perm.size() || seen[p]) {
+            return false;
+        }
+        seen[p] = true;
+    }
+    return true;
+}
+
+// class ids are 0, 1, ..., n - 1 with every id in use
+bool isDenseClassList(const std::vector<int> &classes)
+{
+    std::vector<bool> used;
+    for (auto c : classes) {
+        if (c < 0 || c >= (int)classes.size()) {
+            return false;
+        }
+        if (c >= (int)used.size()) {
+            used.resize(c + 1, false);
+        }
+        used[c] = true;
+    }
+    return std::find(used.begin(), used.end(), false) == used.end();
+}
+
+}
+
+std::string GroupCache::directory()
+{
+    const char *dir = getenv("HYPERSIMPLEX_CACHE_DIR");
+    if (dir && *dir) {
+        return dir;
+    }
+    dir = getenv("XDG_CACHE_HOME");
+    if (dir && *dir) {
+        return std::string(dir) + "/hypersimplex-representer";
+    }
+    dir = getenv("HOME");
+    if (dir && *dir) {
+        return std::string(dir) + "/.cache/hypersimplex-representer";
+    }
+    return std::string();
+}
+
+std::string GroupCache::path(int d, int k, int subgroupMode)
+{
+    const std::string dir = directory();
+    if (dir.empty()) {
+        return dir;
+    }
+    const std::string mode = subgroupMode == 1 ? "-classes" : "";
+    return dir + "/group-" + std::to_string(d) + "-" + std::to_string(k) + mode + ".cache";
+}
+
+bool GroupCache::load(int d, int k, int subgroupMode, int edgeCount, GroupCacheData &data)
+{
+    TRACE_SCOPE("GroupCache::load");
+
+    const std::string file = path(d, k, subgroupMode);
+    if (file.empty()) {
+        return false;
+    }
+
+    int fd = open(file.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) || info.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    void *map = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+
+    Reader reader(static_cast<const char *>(map), info.st_size);
+    GroupCacheData ret;
+    bool valid = reader.raw(s_magic, sizeof(s_magic)) &&
+            reader.int32() == s_version &&
+            reader.int32() == d &&
+            reader.int32() == k &&
+            reader.int32() == edgeCount;
+
+    // anything out of range means a stale or damaged file, it is recomputed then
+    if (valid) {
+        ret.pointCount = reader.int32();
+        valid &= ret.pointCount == (d == 2 * k ? d + 2 : d);
+        ret.groupName = reader.string();
+
+        const int subCount = reader.int32();
+        valid &= subCount > 0;
+        for (int i = 0; i < subCount && valid && reader.ok(); i++) {
+            ret.subgroups.push_back(reader.string());
+
+            std::vector<Permutation> gens;
+            const int genCount = reader.int32();
+            valid &= genCount >= 0;
+            for (int j = 0; j < genCount && valid && reader.ok(); j++) {
+                gens.push_back(reader.ints());
+                valid &= (int)gens.back().size() == ret.pointCount && isPermutation(gens.back());
+            }
+            ret.subgroupGenerators.push_back(gens);
+        }
+
+        ret.vtxTrnsSubgroups = reader.ints();
+        for (std::size_t i = 0; i < ret.vtxTrnsSubgroups.size() && valid && reader.ok(); i++) {
+            valid &= ret.vtxTrnsSubgroups[i] >= 0 && ret.vtxTrnsSubgroups[i] < subCount;
+            ret.edgeClasses.push_back(reader.ints());
+            valid &= (int)ret.edgeClasses.back().size() == edgeCount &&
+                    isDenseClassList(ret.edgeClasses.back());
+        }
+        valid &= reader.ok();
+    }
+    munmap(map, info.st_size);
+
+    if (!valid) {
+        return false;
+    }
+    data = ret;
+    return true;
+}
+
+bool GroupCache::save(int d, int k, int subgroupMode, int edgeCount, const GroupCacheData &data)
+{
+    TRACE_SCOPE("GroupCache::save");
+
+    const std::string dir = directory();
+    const std::string file = path(d, k, subgroupMode);
+    if (file.empty()) {
+        return false;
+    }
+
+    // create the directory and its parent if needed
+    const std::size_t parentEnd = dir.rfind('/');
+    if (parentEnd != std::string::npos && parentEnd > 0) {
+        mkdir(dir.substr(0, parentEnd).c_str(), 0755);
+    }
+    mkdir(dir.c_str(), 0755);
+
+    Writer writer;
+    writer.raw(s_magic, sizeof(s_magic));
+    writer.int32(s_version);
+    writer.int32(d);
+    writer.int32(k);
+    writer.int32(edgeCount);
+
+    writer.int32(data.pointCount);
+    writer.string(data.groupName);
+
+    writer.int32(data.subgroups.size());
+    for (std::size_t i = 0; i < data.subgroups.size(); i++) {
+        writer.string(data.subgroups[i]);
+        writer.int32(data.subgroupGenerators[i].size());
+        for (auto &gen : data.subgroupGenerators[i]) {
+            writer.ints(gen);
+        }
+    }
+
+    writer.ints(data.vtxTrnsSubgroups);
+    for (auto &classes : data.edgeClasses) {
+        writer.ints(classes);
+    }
+
+    // unique per save, concurrent saves of the same file must not share it
+    std::string tmpFile = file + ".tmpXXXXXX";
+    const int fd = mkstemp(&tmpFile[0]);
+    if (fd < 0) {
+        return false;
+    }
+    // mkstemp creates the file only readable by the owner
+    fchmod(fd, 0644);
+    FILE *out = fdopen(fd, "wb");
+    if (!out) {
+        close(fd);
+        remove(tmpFile.c_str());
+        return false;
+    }
+    const std::string &bytes = writer.data();
+    bool ok = fwrite(bytes.data(), 1, bytes.size(), out) == bytes.size();
+    ok &= fclose(out) == 0;
+
+    if (!ok || rename(tmpFile.c_str(), file.c_str())) {
+        remove(tmpFile.c_str());
+        return false;
+    }
+    return true;
+}
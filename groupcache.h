@@ -0,0 +1,64 @@
+/*********************************************************************
+Hypersimplex Representer
+Copyright (C) 2017 Roman Gilg
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#ifndef GROUPCACHE_H
+#define GROUPCACHE_H
+
+#include <string>
+#include <vector>
+
+#include "permgroup.h"
+
+/*
+ * Everything about the automorphism group of one hypersimplex that is
+ * expensive to compute: the subgroups as returned by GAP together with
+ * their generators, the vertex transitive subgroups and the edge
+ * equivalence classes of these.
+ *
+ * Group elements are not stored. They are enumerated from the generators
+ * natively, which is a lot cheaper than reading them from disk.
+ */
+struct GroupCacheData {
+    int pointCount = 0;
+    std::string groupName;
+    std::vector<std::string> subgroups;
+    std::vector<std::vector<Permutation> > subgroupGenerators;
+
+    // indices into 'subgroups'
+    std::vector<int> vtxTrnsSubgroups;
+    // per vertex transitive subgroup the class index of every edge id
+    std::vector<std::vector<int> > edgeClasses;
+};
+
+/*
+ * Versioned binary cache files, one per (d, k) and subgroup mode.
+ *
+ * The files are looked up in $HYPERSIMPLEX_CACHE_DIR, otherwise in
+ * $XDG_CACHE_HOME/hypersimplex-representer or ~/.cache/hypersimplex-representer.
+ * They are memory mapped for loading and replaced atomically on saving.
+ */
+class GroupCache {
+public:
+    static std::string directory();
+    static std::string path(int d, int k, int subgroupMode = 0);
+
+    static bool load(int d, int k, int subgroupMode, int edgeCount, GroupCacheData &data);
+    static bool save(int d, int k, int subgroupMode, int edgeCount, const GroupCacheData &data);
+};
+
+#endif // GROUPCACHE_H
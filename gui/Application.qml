@@ -35,10 +35,15 @@ Layouts.RowLayout {
 
         property int curD: 0
         property int curK: 0
+        property int curSubgroupMode: 0
+
+        property bool paramsChanged: dSpin.value != curD || kSpin.value != curK ||
+                                     subgroupModeCol.mode != curSubgroupMode
 
         function initHypers(d, k) {
             curD = d;
             curK = k;
+            curSubgroupMode = subgroupModeCol.mode;
             backend.createHypersimplex(d, k);
         }
 
@@ -84,16 +89,75 @@ Layouts.RowLayout {
                 Button {
                     id: applyButton
                     text: "Apply"
-                    enabled: backend.ready && (dSpin.value != ctrls.curD || kSpin.value != ctrls.curK);
+                    enabled: ctrls.paramsChanged;
                     onClicked: ctrls.initHypers(dSpin.value, kSpin.value)
                 }
                 Button {
                     id: resetButton
                     text: "Reset"
-                    enabled: (dSpin.value != ctrls.curD || kSpin.value != ctrls.curK) && ctrls.curD != 0;
+                    enabled: ctrls.paramsChanged && ctrls.curD != 0;
                     onClicked: {
                         dSpin.value = ctrls.curD;
                         kSpin.value = ctrls.curK;
+                        if (ctrls.curSubgroupMode == 0) {
+                            subgroupModeAll.checked = true;
+                        } else {
+                            subgroupModeClasses.checked = true;
+                        }
+                    }
+                }
+                ProgressBar {
+                    id: progressBar
+                    width: applyButton.width
+                    visible: !backend.ready
+                    value: backend.progress
+                }
+                Label {
+                    width: applyButton.width
+                    visible: !backend.ready
+                    text: backend.progressText
+                    elide: Text.ElideRight
+                }
+            }
+        }
+
+        GroupBox {
+            id: subgroupModeCol
+
+            width: eigenVectorSelectionCol.width
+            enabled: backend.ready
+
+            title: "Subgroups:"
+
+            property int mode: 0
+
+            Column {
+                height: childrenRect.height
+                width: childrenRect.width
+                spacing: 10
+
+                ExclusiveGroup { id: subgroupModeGroup }
+
+                RadioButton {
+                    id: subgroupModeAll
+                    checked: true
+                    exclusiveGroup: subgroupModeGroup
+                    text: "All subgroups"
+                    onCheckedChanged: {
+                        if (checked) {
+                            subgroupModeCol.mode = 0;
+                        }
+                    }
+                }
+
+                RadioButton {
+                    id: subgroupModeClasses
+                    exclusiveGroup: subgroupModeGroup
+                    text: "Conjugacy class representatives"
+                    onCheckedChanged: {
+                        if (checked) {
+                            subgroupModeCol.mode = 1;
+                        }
                     }
                 }
             }
@@ -164,6 +228,59 @@ Layouts.RowLayout {
             }
         }
 
+        GroupBox {
+            id: eigenSolverCol
+
+            width: eigenVectorSelectionCol.width
+            enabled: backend.ready
+
+            title: "Eigensolver:"
+
+            property int mode: 0
+
+            Column {
+                height: childrenRect.height
+                width: childrenRect.width
+                spacing: 10
+
+                ExclusiveGroup { id: eigenSolverGroup }
+
+                RadioButton {
+                    id: eigenSolverFull
+                    checked: true
+                    exclusiveGroup: eigenSolverGroup
+                    text: "Full spectrum"
+                    onCheckedChanged: {
+                        if (checked) {
+                            eigenSolverCol.mode = 0;
+                        }
+                    }
+                }
+
+                RadioButton {
+                    id: eigenSolverPartial
+                    exclusiveGroup: eigenSolverGroup
+                    text: "Highest Eigenvalues only"
+                    onCheckedChanged: {
+                        if (checked) {
+                            eigenSolverCol.mode = 2;
+                        }
+                    }
+                }
+
+                RadioButton {
+                    id: eigenSolverSymmetryBlocks
+                    exclusiveGroup: eigenSolverGroup
+                    text: "Symmetry adapted blocks"
+                    onCheckedChanged: {
+                        if (checked) {
+                            eigenSolverCol.mode = 3;
+                        }
+                    }
+                }
+            }
+        }
+
         SliderRepeater {
             width: eigenVectorSelectionCol.width
         }
@@ -247,6 +364,8 @@ Layouts.RowLayout {
         id: backend
 
         selEigenvectMode: eigenVectorSelectionCol.mode
+        eigenSolverMode: eigenSolverCol.mode
+        subgroupMode: subgroupModeCol.mode
         onGeometryInitNeeded: wrap3D.initGeometries()
         onGeometryUpdateNeeded: wrap3D.updateGeometries()
     }
@@ -20,68 +20,18 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "combinadic.h"
 #include "autgroup.h"
+#include "constructioncontrol.h"
 #include "gimatrix.h"
+#include "groupcache.h"
+#include "symmetryblocks.h"
+#include "trace.h"
 
 #include <algorithm>
+#include <map>
+#include <numeric>
 
 #include <QDebug>
-
-static void genAsymSd_1d(int dim, int *comp)
-{
-    int dComp = comp[dim - 1];
-
-    for (int i = dim - 1; i > 0; i--) {
-        comp[i] = comp[i-1];
-    }
-    comp[0] = dComp;
-}
-static void genAsymSd_1d_inv(int dim, int *comp)
-{
-    int dComp = comp[0];
-
-    for (int i = 0; i < dim - 1; i++) {
-        comp[i] = comp[i+1];
-    }
-    comp[dim - 1] = dComp;
-}
-static void genAsymSd_12(int dim, int *comp)
-{
-    int tmp = comp[0];
-    comp[0] = comp[1];
-    comp[1] = tmp;
-}
-
-static void genSymS2_12(int dim, int *comp)
-{
-    for (int i = 0; i < dim; i++) {
-        comp[i] = 1 - comp[i];
-    }
-}
-static void genSymSd_1d(int dim, int *comp)
-{
-    int dComp = comp[dim - 1];
-
-    for (int i = dim - 1; i > 0; i--) {
-        comp[i] = 1 - comp[i-1];
-    }
-    comp[0] = 1 - dComp;
-}
-static void genSymSd_1d_inv(int dim, int *comp)
-{
-    int dComp = comp[0];
-
-    for (int i = 0; i < dim - 1; i++) {
-        comp[i] = 1 - comp[i+1];
-    }
-    comp[dim - 1] = 1 - dComp;
-}
-static void genSymSd_12(int dim, int *comp)
-{
-    int tmp = comp[0];
-    comp[0] = comp[1];
-    comp[1] = tmp;
-    genSymS2_12(dim, comp);
-}
+#include <QtConcurrent/QtConcurrentMap>
 
 VtxTrnsSubgroup::VtxTrnsSubgroup(std::string sub, int index, AutGroup *parent)
     : m_gapName(sub),
@@ -89,17 +39,6 @@ VtxTrnsSubgroup::VtxTrnsSubgroup(std::string sub, int index, AutGroup *parent)
       m_parent(parent)
 {}
 
-Edge::Edge(int _v, int _w)
-{
-    if (_v <= _w) {
-        v = _v;
-        w = _w;
-    } else {
-        v = _w;
-        w = _v;
-    }
-}
-
 EdgeEquivClass::EdgeEquivClass(std::vector<Edge> edges)
     : m_edges(edges)
 {}
@@ -124,20 +63,23 @@ bool EdgeEquivClass::has(Edge edge)
     return std::any_of(m_edges.begin(), m_edges.end(), [&edge](Edge comp){return comp == edge;});
 }
 
-Hypersimplex::Hypersimplex(int d, int k)
+Hypersimplex::Hypersimplex(int d, int k, int subgroupMode, ConstructionControl *control)
     : m_d(d),
       m_k(k),
-      m_vertexCount(binomCoeff(d, k))
+      m_subgroupMode(subgroupMode),
+      m_combinadic(d, k),
+      m_vertexCount(binomCoeff(d, k)),
+      m_control(control)
 {
     qDebug() << "Create H:" << d << k;
-
-    initVertices();
-    initEdges();
-    initGroup();
 }
 
 Hypersimplex::~Hypersimplex()
 {
+    for (auto sub : m_vtxTrnsSubgroups) {
+        for_each(sub->m_edgeEquivClasses.begin(), sub->m_edgeEquivClasses.end(), [](EdgeEquivClass *ptr){delete ptr;});
+        delete sub;
+    }
     delete m_group;
 }
 
@@ -151,26 +93,61 @@ std::vector<std::string> Hypersimplex::getVtxTrSubgroupNames()
     return ret;
 }
 
-bool Hypersimplex::haveEdge(int v, int w)
+void Hypersimplex::initVertices()
 {
-    int vComb[m_d] = {0};
-    int wComb[m_d] = {0};
+    TRACE_SCOPE("Hypersimplex::initVertices");
 
-    combinadicComb(m_k, v, vComb);
-    combinadicComb(m_k, w, wComb);
+    m_vertices.reserve(m_vertexCount);
 
-    int sum = 0;
-    for (int i = 0; i < m_d; i++) {
-        sum += vComb[i] && wComb[i];
+    if (m_d > 64) {
+        for (int i = 0; i < m_vertexCount; i++) {
+            m_vertices.push_back(Vertex(i, m_d, m_k));
+        }
+        return;
     }
 
-    return sum == m_k - 1;
+    std::vector<uint64_t> masks(m_vertexCount);
+    m_combinadic.unrankBatch(0, m_vertexCount, masks.data());
+
+    for (int i = 0; i < m_vertexCount; i++) {
+        m_vertices.push_back(Vertex(i, masks[i], m_d, m_k));
+    }
 }
 
-void Hypersimplex::initVertices()
+void Hypersimplex::swapNeighbours(int vertex, int *neighbours) const
 {
-    for (int i = 0; i < m_vertexCount; i++) {
-        m_vertices.push_back(Vertex(i, m_d, m_k));
+    const Vertex &v = m_vertices[vertex];
+    int count = 0;
+
+    if (v.isWide()) {
+        auto comps = v.comps();
+        for (int i = 0; i < m_d; i++) {
+            if (!comps[i]) {
+                continue;
+            }
+            for (int j = 0; j < m_d; j++) {
+                if (comps[j]) {
+                    continue;
+                }
+                comps[i] = 0;
+                comps[j] = 1;
+                neighbours[count++] = m_combinadic.rank(comps.data());
+                comps[i] = 1;
+                comps[j] = 0;
+            }
+        }
+        return;
+    }
+
+    const uint64_t mask = v.mask();
+    const uint64_t full = m_d == 64 ? ~uint64_t(0) : (uint64_t(1) << m_d) - 1;
+
+    for (uint64_t ones = mask; ones; ones &= ones - 1) {
+        const uint64_t one = ones & (~ones + 1);
+        for (uint64_t zeros = ~mask & full; zeros; zeros &= zeros - 1) {
+            const uint64_t zero = zeros & (~zeros + 1);
+            neighbours[count++] = m_combinadic.rankMask(mask ^ one ^ zero);
+        }
     }
 }
 
@@ -189,521 +166,503 @@ facet_pair Hypersimplex::getFacetPair(int index) const
 
 void Hypersimplex::initEdges()
 {
-    for (int i = 0; i < m_vertexCount; i++) {
-        for (int j = i + 1; j < m_vertexCount; j++) {
-            if (haveEdge(i, j)) {
-                m_edges.push_back(Edge(i, j));
-            }
-        }
-    }
+    TRACE_SCOPE("Hypersimplex::initEdges");
+
+    // every vertex has k(d-k) neighbours: swap one of its ones with one of its zeros
+    m_degree = m_k * (m_d - m_k);
+
+    std::vector<std::size_t> offsets(m_vertexCount + 1);
+    std::vector<int> neighbours((std::size_t)m_vertexCount * m_degree);
 
-    qDebug() << "Edges:";
-    for (auto e: m_edges) {
-        qDebug() << "[" << e.v << "--" << e.w << "]";
+    for (int v = 0; v < m_vertexCount; v++) {
+        offsets[v] = (std::size_t)v * m_degree;
+
+        int *row = neighbours.data() + offsets[v];
+        swapNeighbours(v, row);
+        std::sort(row, row + m_degree);
+    }
+    offsets[m_vertexCount] = neighbours.size();
+
+    m_adjacency = Adjacency(offsets, neighbours);
+    TRACE_COUNTER("edges", m_adjacency.edgeCount());
+}
+
+const char *Hypersimplex::stageName(int stage)
+{
+    switch (stage) {
+    case VerticesStage:
+        return "Vertices";
+    case EdgesStage:
+        return "Edges";
+    case GroupStage:
+        return "Subgroups";
+    case VtxTrnsStage:
+        return "Vertex transitivity";
+    case EdgeClassesStage:
+        return "Edge equivalence classes";
+    default:
+        return "";
     }
 }
 
-void Hypersimplex::initGroup()
+bool Hypersimplex::isCanceled() const
 {
-    m_group = new AutGroup(m_d, m_k);
+    return m_control && m_control->isCanceled();
 }
 
-void Hypersimplex::initCalculations()
+bool Hypersimplex::enterStage(Stage stage)
 {
-    m_degree = getEdgesToVertex(0).size();
+    if (isCanceled()) {
+        return false;
+    }
+    if (m_control) {
+        m_control->enterStage(stage);
+    }
+    return true;
+}
 
-    qDebug() << "---------------";
-    calcVtxTrnsSubgroups();
-    qDebug() << "---------------";
-    qDebug() << "---------------";
-    qDebug() << "vtxtrns subs:" << m_vtxTrnsSubgroups.size();
-    for (auto s : m_vtxTrnsSubgroups)
-        qDebug() << QString(s->m_gapName.c_str());
+void Hypersimplex::init()
+{
+    if (!enterStage(VerticesStage)) {
+        return;
+    }
+    initVertices();
 
-    qDebug() << "---------------";
-    qDebug() << "---------------";
-    calcEdgeEquivClasses();
+    if (!enterStage(EdgesStage)) {
+        return;
+    }
+    initEdges();
 
-    qDebug() << "---------------";
-    qDebug() << "---------------";
-    qDebug() << "EECs of subgroups:";
-    for (auto s : m_vtxTrnsSubgroups) {
-        qDebug() << "---------------";
-        qDebug() << QString(s->m_gapName.c_str());
-
-        qDebug() << "EEC count:" << s->m_edgeEquivClasses.size();
-        int index = 1;
-        for (auto eec : s->m_edgeEquivClasses) {
-            std::string debug = "class " + std::to_string(index) + " (mult " + std::to_string(eec->multiplicity) + ")" + ": ";
-            std::vector<Edge>::const_iterator it = eec->m_edges.cbegin();
-            while (it != eec->m_edges.cend()) {
-                if (it != eec->m_edges.cbegin()) {
-                    debug +=  + " | ";
-                }
-                debug += std::to_string(it->v) + "--" + std::to_string(it->w);
-                it++;
-            }
-            qDebug() << debug.c_str();
-            index++;
-        }
+    if (!enterStage(GroupStage)) {
+        return;
     }
+    initGroup();
 
-    qDebug() << "initCalculations DONE";
-}
+    if (isCanceled()) {
+        return;
+    }
+    initCalculations();
 
-GiMatrix Hypersimplex::getGiMatrix(int subgroup)
-{
-    return GiMatrix(this, m_vtxTrnsSubgroups[subgroup]);
+    m_complete = !isCanceled();
 }
 
-bool Hypersimplex::isEdge(int vertex1, int vertex2)
+void Hypersimplex::initGroup()
 {
-    Edge edge(vertex1, vertex2);
-
-    auto compOnFirstVertex = [](const Edge &e1, const Edge &e2) -> bool {
-        return e1.v <= e2.v;
-    };
-    auto range = std::equal_range(m_edges.begin(), m_edges.end(), edge, compOnFirstVertex);
-    auto ptr = std::lower_bound(range.first, range.second, edge);
+    TRACE_SCOPE("Hypersimplex::initGroup");
 
-    return ptr != range.second && *ptr == edge;
+    GroupCacheData cached;
+    if (GroupCache::load(m_d, m_k, m_subgroupMode, m_adjacency.edgeCount(), cached)) {
+        m_group = new AutGroup(cached);
+        restoreFromCache(cached);
+        return;
+    }
+    m_group = new AutGroup(m_d, m_k);
+    initSubgroups();
 }
 
-void Hypersimplex::calcVtxTrnsSubgroups()
+void Hypersimplex::initSubgroups()
 {
-    int index = 0;
-    for (auto sub : m_group->getSubgroups()) {
-        if (isVtxTrnsSubgroup(index)) {
-            m_vtxTrnsSubgroups.push_back(new VtxTrnsSubgroup(sub, index, m_group));
-        }
-        index++;
+    TRACE_SCOPE("Hypersimplex::initSubgroups");
+
+    if (m_control) {
+        AutGroup *group = m_group;
+        m_control->setCancelHook([group]() {
+            group->interrupt();
+        });
+    }
+    m_subgroupsValid = m_group->calcSubgroups(m_subgroupMode);
+    if (m_control) {
+        m_control->setCancelHook(std::function<void()>());
     }
 }
 
-bool Hypersimplex::isVtxTrnsSubgroup(int sub)
+void Hypersimplex::initCalculations()
 {
-    bool vertexHits[m_vertexCount] = {false};
-
-    for (auto factored : m_group->getFactorizations(sub)) {
-        int res[m_vertexCount];
-        startPermutate(factored, res);
+    if (!m_restoredFromCache) {
+        if (!enterStage(VtxTrnsStage)) {
+            return;
+        }
+        calcVtxTrnsSubgroups();
 
-        vertexHits[res[0]] = true;
-    }
+        if (!enterStage(EdgeClassesStage)) {
+            return;
+        }
+        calcEdgeEquivClasses();
 
-    for (auto hit : vertexHits) {
-        if (!hit) {
-            return false;
+        // never cache partial results
+        if (isCanceled()) {
+            return;
+        }
+        if (m_subgroupsValid) {
+            saveToCache();
         }
     }
-    return true;
+
+    qDebug() << "Vertex transitive subgroups:" << m_vtxTrnsSubgroups.size();
 }
 
-std::vector<Edge> Hypersimplex::getEdgesToVertex(int vertex)
+void Hypersimplex::restoreFromCache(const GroupCacheData &data)
 {
-    std::vector<Edge> ret;
-    for (auto e : m_edges) {
-        if (e.has(vertex)) {
-            ret.push_back(e);
-        }
+    for (std::size_t i = 0; i < data.vtxTrnsSubgroups.size(); i++) {
+        const int index = data.vtxTrnsSubgroups[i];
+        auto sub = new VtxTrnsSubgroup(data.subgroups[index], index, m_group);
+
+        setEdgeClasses(sub, data.edgeClasses[i]);
+        m_vtxTrnsSubgroups.push_back(sub);
     }
-    return ret;
+    m_restoredFromCache = true;
 }
 
-void Hypersimplex::calcEdgeEquivClasses()
+void Hypersimplex::saveToCache() const
 {
+    TRACE_SCOPE("Hypersimplex::saveToCache");
+
+    GroupCacheData data;
+    m_group->fillCacheData(data);
 
-    auto hasEdge = [](std::vector<Edge> &edges, Edge &e) {
-        return std::any_of(edges.begin(), edges.end(), [&e](Edge comp){return comp == e;});
-    };
     for (auto sub : m_vtxTrnsSubgroups) {
-        qDebug() << QString(sub->m_gapName.c_str());
+        data.vtxTrnsSubgroups.push_back(sub->m_index);
+        data.edgeClasses.push_back(sub->m_edgeClasses);
+    }
 
-        std::vector<EdgeEquivClass *> eecs;
+    if (!GroupCache::save(m_d, m_k, m_subgroupMode, m_adjacency.edgeCount(), data)) {
+        qDebug() << "Warning: Could not write group cache" << GroupCache::path(m_d, m_k, m_subgroupMode).c_str();
+    }
+}
 
-        std::vector<int*> imgList;
+GiMatrix Hypersimplex::getGiMatrix(int subgroup)
+{
+    return GiMatrix(this, m_vtxTrnsSubgroups[subgroup]);
+}
 
-        for (auto fac : m_group->getFactorizations(sub->m_index)) {
-            int *vertices = new int[m_vertexCount];
-            startPermutate(fac, vertices);
+std::shared_ptr<const SymmetryBlocks> Hypersimplex::getSymmetryBlocks(VtxTrnsSubgroup *sub)
+{
+    std::lock_guard<std::mutex> lock(m_subgroupDataMutex);
+    std::shared_ptr<const SymmetryBlocks> blocks = sub->m_symmetryBlocks.lock();
+    if (!blocks) {
+        const std::vector<Permutation> &gens = m_group->getSubgroupGenerators(sub->m_index);
+        std::vector<std::vector<int> > vertexGens(gens.size(), std::vector<int>(m_vertexCount));
 
-            imgList.push_back(vertices);
+        for (std::size_t i = 0; i < gens.size(); i++) {
+            permutateVertices(gens[i], vertexGens[i].data());
         }
+        blocks = std::make_shared<SymmetryBlocks>(m_vertexCount, vertexGens);
+        sub->m_symmetryBlocks = blocks;
+    }
+    return blocks;
+}
 
-        std::vector<int> vertexHits;
-
-        for (int vertex = 0; vertex < m_vertexCount; vertex++) {
-            auto testOnHit = [this, &vertexHits](int v) {
-                for (auto w : vertexHits) {
-                    Edge e(v, w);
-                    if (std::any_of(m_edges.begin(), m_edges.end(), [&e](Edge comp){return comp == e;})) {
-                        return true;
-                    }
-                }
-                return false;
-            };
-
-            /* we don't need to test vertices which have an edge
-             * to a vertex whose edges already have been tested
-             */
-            if (testOnHit(vertex)) {
-                continue;
-            }
-            vertexHits.push_back(vertex);
-            std::vector<Edge> vertexEdges = getEdgesToVertex(vertex);
-
-            for (auto vEdge : vertexEdges) {
-                std::vector<Edge> edgeImgs;
-
-                for (auto el :  m_group->getFactorizations(sub->m_index)) {
-                    auto edgeImg = [this](Edge e, std::string factoredPerm) {
-                        auto imgV = permutateVertex(factoredPerm, e.v);
-                        auto imgW = permutateVertex(factoredPerm, e.w);
-                        return Edge(imgV, imgW);
-                    };
-                    auto eI = edgeImg(vEdge, el);
-                    if (!hasEdge(edgeImgs, eI)) {
-                        edgeImgs.push_back(eI);
-                    }
-                }
+int Hypersimplex::getConjugateCount(int subgroup)
+{
+    return getConjugators(m_vtxTrnsSubgroups[subgroup]).size();
+}
 
-                // add edges to existing class or create new one
-                bool addToClass = false;
-                for (auto c : eecs) {
-                    // test first if one of the mapped edges is in this class already
-                    for (auto e : edgeImgs) {
-                        if (hasEdge(c->m_edges, e)) {
-                            addToClass = true;
-                            break;
-                        }
-                    }
-
-                    // test also if one of the edges already in class 'c' is in the image
-                    if (!addToClass) {
-                        for (auto e : c->m_edges) {
-                            if (hasEdge(edgeImgs, e)) {
-                                addToClass = true;
-                                break;
-                            }
-                        }
-                    }
-
-                    if (addToClass) {
-                        // add new edges to class 'c'
-
-                        std::string debug;
-                        for (auto e : c->m_edges)
-                            debug += std::to_string(e.v) + std::to_string(e.w) + "|";
-
-                        for (auto eI : edgeImgs) {
-                            if (!hasEdge(c->m_edges, eI)) {
-                                c->m_edges.push_back(eI);
-                            }
-                        }
-                        break;
-                    }
-                }
+// smallest point in the orbit of every point, equal for equal groups
+static std::vector<int> orbitPartition(const std::vector<Permutation> &gens, int degree)
+{
+    std::vector<int> partition(degree);
+    std::iota(partition.begin(), partition.end(), 0);
 
-                if (!addToClass) {
-                    // class is not yet listed in class_list
-                    auto eec = new EdgeEquivClass(edgeImgs);
-                    eecs.push_back(eec);
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto &gen : gens) {
+            for (int p = 0; p < degree; p++) {
+                const int low = std::min(partition[p], partition[gen[p]]);
+                if (partition[p] != low || partition[gen[p]] != low) {
+                    partition[p] = partition[gen[p]] = low;
+                    changed = true;
                 }
             }
         }
-
-        for (auto c : eecs) {
-            std::sort (c->m_edges.begin(), c->m_edges.end(), [](Edge e, Edge l) { return e.v < l.v || e.v == l.v && e.w <= l.w; });
-            c->calcMultiplicity();
-        }
-
-        for_each(sub->m_edgeEquivClasses.begin(), sub->m_edgeEquivClasses.end(), [](EdgeEquivClass *ptr){delete ptr;});
-        sub->m_edgeEquivClasses = eecs;
-
-        for_each(imgList.begin(), imgList.end(), [](int *ptr){delete ptr;});
     }
+    return partition;
 }
 
-void Hypersimplex::startPermutate(std::string factoredPerm, int *result)
+/*
+ * Orbit of the subgroup H under conjugation with the generators of the full
+ * group. Conjugates have the same order, so K is a known conjugate C if all
+ * generators of K lie in C. Only conjugates with equal orbits on the points
+ * are compared.
+ */
+const std::vector<Permutation> &Hypersimplex::getConjugators(VtxTrnsSubgroup *sub)
 {
-    for (int i = 0; i < m_vertexCount; i++) {
-        result[i] = i;
+    std::lock_guard<std::mutex> lock(m_subgroupDataMutex);
+    if (!sub->m_conjugators.empty()) {
+        return sub->m_conjugators;
     }
-    permutateVertices(factoredPerm, result);
-}
+    TRACE_SCOPE("Hypersimplex::getConjugators");
 
-void Hypersimplex::permutateVertices(std::string factoredPerm, int *vertices)
-{
-    if (factoredPerm[0] == '<') {
-        return;
-    }
+    const int degree = m_group->pointCount();
+    const std::vector<Permutation> &gens = m_group->getSubgroupGenerators(sub->m_index);
+
+    std::vector<PermGroup> conjugates;
+    std::vector<Permutation> conjugators;
+    std::map<std::vector<int>, std::vector<int> > conjugatesByOrbits;
+
+    conjugates.push_back(PermGroup(degree, gens));
+    conjugators.push_back(identityPermutation(degree));
+    conjugatesByOrbits[orbitPartition(gens, degree)].push_back(0);
+
+    for (std::size_t i = 0; i < conjugates.size(); i++) {
+        for (auto &s : m_group->getGenerators()) {
+            const Permutation sInv = inversePermutation(s);
 
-    int input[m_vertexCount];
-    std::copy(vertices, vertices + m_vertexCount, input);
+            std::vector<Permutation> conjGens;
+            for (auto &h : conjugates[i].generators()) {
+                conjGens.push_back(composePermutations(s, composePermutations(h, sInv)));
+            }
 
-    std::vector<int *>parsedFactoredPerm = parsePermutation(factoredPerm);
+            std::vector<int> &candidates = conjugatesByOrbits[orbitPartition(conjGens, degree)];
+            const bool known = std::any_of(candidates.begin(), candidates.end(), [&](int c) {
+                return std::all_of(conjGens.begin(), conjGens.end(), [&](const Permutation &perm) {
+                    return conjugates[c].contains(perm);
+                });
+            });
+            if (known) {
+                continue;
+            }
 
-    for (auto factor : parsedFactoredPerm) {
-        int input[m_vertexCount];
-        std::copy(vertices, vertices + m_vertexCount, input);
-        for (int i=0; i < m_vertexCount; i++) {
-            vertices[factor[i]] = input[i];
+            candidates.push_back(conjugates.size());
+            conjugates.push_back(PermGroup(degree, conjGens));
+            conjugators.push_back(composePermutations(s, conjugators[i]));
         }
     }
+    TRACE_COUNTER("conjugates", conjugators.size());
+
+    sub->m_conjugators = conjugators;
+    return sub->m_conjugators;
 }
 
-int Hypersimplex::permutateVertex(std::string factoredPerm, int vertex)
+std::vector<int> Hypersimplex::getVertexRelabelling(const Permutation &perm) const
 {
-    int vertices[m_vertexCount];
-    startPermutate(factoredPerm, vertices);
-    return vertices[vertex];
+    std::vector<int> images(m_vertexCount);
+    permutateVertices(perm, images.data());
+    return images;
 }
 
-AsymHypers::AsymHypers(int d, int k)
-    : Hypersimplex(d, k)
+bool Hypersimplex::isEdge(int vertex1, int vertex2)
 {
-    m_genAsymSd_1d = new int[m_vertexCount];
-    m_genAsymSd_1d_inv = new int[m_vertexCount];
-    m_genAsymSd_12 = new int[m_vertexCount];
+    return m_adjacency.edgeId(vertex1, vertex2) != -1;
+}
 
-    int genAsymSd_1d_result[m_vertexCount][m_d];
-    int genAsymSd_1d_inv_result[m_vertexCount][m_d];
-    int genAsymSd_12_result[m_vertexCount][m_d];
+void Hypersimplex::calcVtxTrnsSubgroups()
+{
+    TRACE_SCOPE("Hypersimplex::calcVtxTrnsSubgroups");
 
-    for (int i = 0; i < m_vertexCount; i++) {
-        int comps[m_d] = {0};
-        combinadicComb(m_k, i, comps);
+    const std::vector<std::string> subgroups = m_group->getSubgroups();
 
-        std::copy(comps, comps + m_d, genAsymSd_1d_result[i]);
-        std::copy(comps, comps + m_d, genAsymSd_1d_inv_result[i]);
-        std::copy(comps, comps + m_d, genAsymSd_12_result[i]);
+    // the generators are parsed already, so the workers never touch the GAP pipe
+    std::vector<int> indices(subgroups.size());
+    std::iota(indices.begin(), indices.end(), 0);
+    std::vector<char> transitive(subgroups.size(), 0);
 
-        genAsymSd_1d(m_d, genAsymSd_1d_result[i]);
-        genAsymSd_1d_inv(m_d, genAsymSd_1d_inv_result[i]);
-        genAsymSd_12(m_d, genAsymSd_12_result[i]);
-    }
+    QtConcurrent::blockingMap(indices, [this, &transitive](int index) {
+        if (!isCanceled()) {
+            transitive[index] = isVtxTrnsSubgroup(index);
+        }
+    });
 
-    for (int i = 0; i < m_vertexCount; i++) {
-        m_genAsymSd_1d[i] = combinadicN(m_d, genAsymSd_1d_result[i]);
-        m_genAsymSd_1d_inv[i] = combinadicN(m_d, genAsymSd_1d_inv_result[i]);
-        m_genAsymSd_12[i] = combinadicN(m_d, genAsymSd_12_result[i]);
+    // in subgroup order, independent of the scheduling
+    for (int index = 0; index < (int)subgroups.size(); index++) {
+        if (transitive[index]) {
+            m_vtxTrnsSubgroups.push_back(new VtxTrnsSubgroup(subgroups[index], index, m_group));
+        }
     }
-
-    initCalculations();
-}
-
-AsymHypers::~AsymHypers()
-{
-    delete[] m_genAsymSd_1d;
-    delete[] m_genAsymSd_1d_inv;
-    delete[] m_genAsymSd_12;
+    TRACE_COUNTER("vertex transitive subgroups", m_vtxTrnsSubgroups.size());
 }
 
-SymHypers::SymHypers(int d, int k)
-    : Hypersimplex(d, k)
+/*
+ * Grows the orbit of vertex 0 under the subgroup generators. The subgroup is
+ * vertex transitive if and only if this orbit reaches every vertex.
+ * Only reads shared data, the subgroups are screened concurrently.
+ */
+bool Hypersimplex::isVtxTrnsSubgroup(int sub) const
 {
-    m_genSymS2_12 = new int[m_vertexCount];
-    m_genSymSd_1d = new int[m_vertexCount];
-    m_genSymSd_1d_inv = new int[m_vertexCount];
-    m_genSymSd_12 = new int[m_vertexCount];
+    const std::vector<Permutation> &gens = m_group->getSubgroupGenerators(sub);
 
-    int genSymS2_12_result[m_vertexCount][m_d];
-    int genSymSd_1d_result[m_vertexCount][m_d];
-    int genSymSd_1d_inv_result[m_vertexCount][m_d];
-    int genSymSd_12_result[m_vertexCount][m_d];
-
-    for (int i = 0; i < m_vertexCount; i++) {
-        int comps[m_d] = {0};
-        combinadicComb(m_k, i, comps);
+    std::vector<bool> complements;
+    for (auto &gen : gens) {
+        complements.push_back(isComplementing(gen));
+    }
 
-        std::copy(comps, comps + m_d, genSymS2_12_result[i]);
-        std::copy(comps, comps + m_d, genSymSd_1d_result[i]);
-        std::copy(comps, comps + m_d, genSymSd_1d_inv_result[i]);
-        std::copy(comps, comps + m_d, genSymSd_12_result[i]);
+    std::vector<bool> vertexHits(m_vertexCount, false);
+    std::vector<int> orbit;
+    orbit.reserve(m_vertexCount);
 
-        genSymS2_12(m_d, genSymS2_12_result[i]);
-        genSymSd_1d(m_d, genSymSd_1d_result[i]);
-        genSymSd_1d_inv(m_d, genSymSd_1d_inv_result[i]);
-        genSymSd_12(m_d, genSymSd_12_result[i]);
-    }
+    vertexHits[0] = true;
+    orbit.push_back(0);
 
-    for (int i = 0; i < m_vertexCount; i++) {
-        m_genSymS2_12[i] = combinadicN(m_d, genSymS2_12_result[i]);
-        m_genSymSd_1d[i] = combinadicN(m_d, genSymSd_1d_result[i]);
-        m_genSymSd_1d_inv[i] = combinadicN(m_d, genSymSd_1d_inv_result[i]);
-        m_genSymSd_12[i] = combinadicN(m_d, genSymSd_12_result[i]);
+    for (std::size_t i = 0; i < orbit.size(); i++) {
+        if ((int)orbit.size() == m_vertexCount) {
+            return true;
+        }
+        for (std::size_t g = 0; g < gens.size(); g++) {
+            const int img = permutateVertex(gens[g], orbit[i], complements[g]);
+            if (!vertexHits[img]) {
+                vertexHits[img] = true;
+                orbit.push_back(img);
+            }
+        }
     }
-
-    initCalculations();
+    return (int)orbit.size() == m_vertexCount;
 }
 
-SymHypers::~SymHypers()
+static int findClassRoot(std::vector<int> &parent, int edge)
 {
-    delete[] m_genSymS2_12;
-    delete[] m_genSymSd_1d;
-    delete[] m_genSymSd_1d_inv;
-    delete[] m_genSymSd_12;
+    while (parent[edge] != edge) {
+        parent[edge] = parent[parent[edge]];
+        edge = parent[edge];
+    }
+    return edge;
 }
 
-std::string Hypersimplex::prepareForParsing(const std::string &perm)
+/*
+ * The edge equivalence classes are the edge orbits of the subgroup. They are
+ * found by joining every edge with its images under the subgroup generators.
+ */
+void Hypersimplex::calcEdgeEquivClasses()
 {
-    std::string ret;
-    std::size_t pos = 0;
+    TRACE_SCOPE("Hypersimplex::calcEdgeEquivClasses");
 
-    auto inverteParsedPart = [](const std::string part) {
-        std::size_t pos = 0;
-        std::string ret;
-        while (pos != std::string::npos) {
-            std::string cur = part.substr(pos, 2) + '^';
-            if (part[pos + 2] == '^') {
-                if (part[pos + 3] == '-') {
-                    // TODO: only reads in exponents with one digit
-                    cur += part[pos + 4];
-                    pos += 5;
-                } else {
-                    cur += '-';
-                    // TODO: only reads in exponents with one digit
-                    cur += part[pos + 3];
-                    pos += 4;
-                }
-            } else {
-                cur += '1';
-                pos += 2;
-            }
-            ret = cur + ret;
+    const int edgeCount = m_adjacency.edgeCount();
+    std::vector<int> images(m_vertexCount);
+    std::vector<int> parent(edgeCount);
+
+    for (auto sub : m_vtxTrnsSubgroups) {
+        if (isCanceled()) {
+            return;
+        }
+        for (int e = 0; e < edgeCount; e++) {
+            parent[e] = e;
         }
-        return ret;
-    };
-
-    while (pos != std::string::npos) {
-        std::size_t partEnd;
-        std::string part;
-
-        if (perm[pos] == '(') {
-            int brackets = 1;
-            std::size_t subpos = pos;
-            while (brackets > 0) {
-                partEnd = perm.find_first_of("()", subpos + 1);
-                if (perm[partEnd] == ')') {
-                    brackets--;
-                } else {
-                    brackets++;
+
+        for (auto &gen : m_group->getSubgroupGenerators(sub->m_index)) {
+            permutateVertices(gen, images.data());
+
+            for (int e = 0; e < edgeCount; e++) {
+                const Edge &edge = m_adjacency.edge(e);
+                const int imgEdge = m_adjacency.edgeId(images[edge.v], images[edge.w]);
+
+                const int root = findClassRoot(parent, e);
+                const int imgRoot = findClassRoot(parent, imgEdge);
+
+                // the smallest edge id stays the root of its class
+                if (root < imgRoot) {
+                    parent[imgRoot] = root;
+                } else if (imgRoot < root) {
+                    parent[root] = imgRoot;
                 }
-                subpos = partEnd + 1;
-            }
-            part = prepareForParsing(perm.substr(pos + 1, partEnd - (pos + 1)));
-            int times;
-            bool inverse;
-
-            if (perm[partEnd + 2] == '-') {
-                // TODO: only reads in exponents with one digit
-                times = perm[partEnd + 3] - '0';
-                inverse = true;
-                part = inverteParsedPart(part);
-                pos = partEnd + 4;
-            } else {
-                // TODO: only reads in exponents with one digit
-                times = perm[partEnd + 2] - '0';
-                inverse = false;
-                pos = partEnd + 3;
             }
+        }
+
+        // number the classes in order of their smallest edge
+        std::vector<int> classOfRoot(edgeCount, -1);
+        std::vector<int> classes(edgeCount);
+        int classCount = 0;
 
-            while (times > 0) {
-                ret += part;
-                times--;
+        for (int e = 0; e < edgeCount; e++) {
+            const int root = findClassRoot(parent, e);
+            if (classOfRoot[root] == -1) {
+                classOfRoot[root] = classCount++;
             }
-        } else {
-            partEnd = perm.find('(', pos + 1);
-            part = perm.substr(pos, partEnd - pos);
-            ret += part;
-            pos = partEnd;
+            classes[e] = classOfRoot[root];
         }
+        setEdgeClasses(sub, classes);
     }
-    return ret;
 }
 
-std::vector<int *> AsymHypers::parsePermutation(std::string perm)
+void Hypersimplex::setEdgeClasses(VtxTrnsSubgroup *sub, const std::vector<int> &classes)
 {
-    std::vector<int *> ret;
-    std::size_t pos = 0;
-
-    perm = prepareForParsing(perm);
+    std::vector<std::vector<Edge> > classEdges;
+    for (int id = 0; id < m_adjacency.edgeCount(); id++) {
+        if (classes[id] >= (int)classEdges.size()) {
+            classEdges.resize(classes[id] + 1);
+        }
+        classEdges[classes[id]].push_back(m_adjacency.edge(id));
+    }
 
-    while (pos != std::string::npos) {
-        char symbol = perm[pos + 1];
-        int times = 1;
-        bool inverse = false;
+    for_each(sub->m_edgeEquivClasses.begin(), sub->m_edgeEquivClasses.end(), [](EdgeEquivClass *ptr){delete ptr;});
+    sub->m_edgeEquivClasses.clear();
 
-        if (perm[pos + 2] == '^') {
-            if (perm[pos + 3] == '-') {
-                inverse = true;
-                times = perm[pos + 4] - '0';
-            } else {
-                times = perm[pos + 3] - '0';
-            }
-        }
+    for (auto &edges : classEdges) {
+        auto eec = new EdgeEquivClass(edges);
+        eec->calcMultiplicity();
+        sub->m_edgeEquivClasses.push_back(eec);
+    }
+    sub->m_edgeClasses = classes;
+}
 
-        int *ptr;
-        if (symbol == '1') {
-            ptr = inverse ? m_genAsymSd_1d_inv : m_genAsymSd_1d;
-        } else {
-            ptr = m_genAsymSd_12;
-        }
+int Hypersimplex::permutateVertex(const Permutation &perm, int vertex, bool complement) const
+{
+    const Vertex &v = m_vertices[vertex];
 
-        while (times > 0) {
-            ret.push_back(ptr);
-            times--;
+    if (v.isWide()) {
+        auto comps = v.comps();
+        std::vector<int> img(m_d);
+        for (int i = 0; i < m_d; i++) {
+            img[perm[i]] = complement ? 1 - comps[i] : comps[i];
         }
-
-        pos = perm.find('x', pos + 1);
+        return m_combinadic.rank(img.data());
     }
 
-    return ret;
+    uint64_t img = 0;
+    for (uint64_t bits = v.mask(); bits; bits &= bits - 1) {
+        img |= uint64_t(1) << perm[__builtin_ctzll(bits)];
+    }
+    if (complement) {
+        img ^= m_d == 64 ? ~uint64_t(0) : (uint64_t(1) << m_d) - 1;
+    }
+    return m_combinadic.rankMask(img);
 }
 
-std::vector<int *> SymHypers::parsePermutation(std::string perm)
+void Hypersimplex::permutateVertices(const Permutation &perm, int *images) const
 {
-    std::vector<int *> ret;
-    std::size_t pos = 0;
+    const bool complement = isComplementing(perm);
+    for (int v = 0; v < m_vertexCount; v++) {
+        images[v] = permutateVertex(perm, v, complement);
+    }
+}
 
-    perm = prepareForParsing(perm);
+AsymHypers::AsymHypers(int d, int k, int subgroupMode, ConstructionControl *control)
+    : AsymHypers(d, k, subgroupMode, control, true)
+{}
 
-    while (pos != std::string::npos) {
-        char symbol = perm[pos + 1];
-        int times = 1;
-        bool inverse = false;
+AsymHypers::AsymHypers(int d, int k, int subgroupMode, ConstructionControl *control, bool runInit)
+    : Hypersimplex(d, k, subgroupMode, control)
+{
+    if (runInit) {
+        init();
+    }
+}
 
-        if (perm[pos + 2] == '^') {
-            if (perm[pos + 3] == '-') {
-                inverse = true;
-                times = perm[pos + 4] - '0';
-            } else {
-                times = perm[pos + 3] - '0';
-            }
-        }
+bool AsymHypers::isComplementing(const Permutation &) const
+{
+    return false;
+}
 
-        int *ptr;
-        if (symbol == '3') {
-            while (times > 0) {
-                ret.push_back(m_genSymS2_12);
-                ret.push_back(m_genSymSd_12);
-                times--;
-            }
-        } else {
-            if (symbol == '1') {
-                ptr = inverse ? m_genSymSd_1d_inv : m_genSymSd_1d;
-            } else {
-                ptr = m_genSymSd_12;
-            }
-            while (times > 0) {
-                ret.push_back(ptr);
-                times--;
-            }
-        }
+SymHypers::SymHypers(int d, int k, int subgroupMode, ConstructionControl *control)
+    : SymHypers(d, k, subgroupMode, control, true)
+{}
 
-        pos = perm.find('x', pos + 1);
+SymHypers::SymHypers(int d, int k, int subgroupMode, ConstructionControl *control, bool runInit)
+    : Hypersimplex(d, k, subgroupMode, control)
+{
+    if (runInit) {
+        init();
     }
-
-    return ret;
 }
 
+bool SymHypers::isComplementing(const Permutation &perm) const
+{
+    // (sigma, tau) permutes the coordinates by sigma and complements the
+    // vertex if tau + sgn(sigma) is odd, the natural action twisted by the sign
+    // parity of the inversions, once per permutation, so quadratic in d is fine
+    bool odd = perm[m_d] != m_d;
+    for (int i = 0; i < m_d; i++) {
+        for (int j = i + 1; j < m_d; j++) {
+            odd ^= perm[i] > perm[j];
+        }
+    }
+    return odd;
+}
@@ -19,28 +19,30 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef HYPERSIMPLEX_H
 #define HYPERSIMPLEX_H
 
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
+#include "adjacency.h"
+#include "combinadic.h"
+#include "permgroup.h"
 #include "vertex.h"
 
 class AutGroup;
+class ConstructionControl;
 class GiMatrix;
+class SymmetryBlocks;
+struct GroupCacheData;
 
 typedef std::pair<std::vector<Vertex>, std::vector<Vertex> > facet_pair;
 
-struct Edge {
-    Edge(int _v, int _w);
-    inline bool operator==(Edge const& b) { return v == b.v && w == b.w; }
-    inline bool operator!=(Edge const& b){ return !(*this == b); }
-    inline bool operator<(Edge const& b) const { return v <= b.v && w < b.w; }
-    inline bool has(int vertex) { return v == vertex || w == vertex; }
-    int v, w;
-};
-
 struct EdgeEquivClass {
     EdgeEquivClass(std::vector<Edge> edges);
     bool has(Edge edge);
+    int size() const {
+        return m_edges.size();
+    }
     std::vector<Edge> m_edges;
     int calcMultiplicity();
     int multiplicity = 0;
@@ -52,113 +54,147 @@ struct VtxTrnsSubgroup {
     int m_index;
     AutGroup *m_parent;
     std::vector<EdgeEquivClass *> m_edgeEquivClasses;
+    // class index of every edge id
+    std::vector<int> m_edgeClasses;
+    // computed on first use, kept only as long as a matrix holds them
+    std::weak_ptr<const SymmetryBlocks> m_symmetryBlocks;
+    // point permutations g with the conjugates g H g^-1, the first is the identity
+    std::vector<Permutation> m_conjugators;
 };
 
 class Hypersimplex {
 public:
+    // construction stages as reported to a ConstructionControl
+    enum Stage {
+        VerticesStage,
+        EdgesStage,
+        GroupStage,
+        VtxTrnsStage,
+        EdgeClassesStage,
+        StageCount
+    };
+    static const char *stageName(int stage);
+
     virtual ~Hypersimplex();
 
+    // false if the construction was canceled
+    bool isComplete() const {
+        return m_complete;
+    }
+
     inline int d() { return m_d; }
     inline int k() { return m_k; }
     inline int vertexCount() { return m_vertexCount; }
     inline int degree() { return m_degree; }
+    inline int subgroupMode() { return m_subgroupMode; }
+
+    const Adjacency &adjacency() const {
+        return m_adjacency;
+    }
 
     std::vector<std::string> getVtxTrSubgroupNames();
+    int getVtxTrSubgroupCount() const {
+        return m_vtxTrnsSubgroups.size();
+    }
     GiMatrix getGiMatrix(int subgroup);
+    std::shared_ptr<const SymmetryBlocks> getSymmetryBlocks(VtxTrnsSubgroup *sub);
+
+    /*
+     * Conjugates of a vertex transitive subgroup are enumerated on first use.
+     * The representations of a conjugate are those of the subgroup with the
+     * vertices relabelled by its conjugator.
+     */
+    int getConjugateCount(int subgroup);
+    const std::vector<Permutation> &getConjugators(VtxTrnsSubgroup *sub);
+    // image of every vertex under the point permutation 'perm'
+    std::vector<int> getVertexRelabelling(const Permutation &perm) const;
 
     bool isEdge(int vertex1, int vertex2);
 
     facet_pair getFacetPair(int index = 0) const;
 
 protected:
-    Hypersimplex(int d, int k);
+    // subgroup mode as in AutGroup::calcSubgroups
+    Hypersimplex(int d, int k, int subgroupMode, ConstructionControl *control = nullptr);
+
+    // runs the construction stages below in order
+    void init();
 
+    void initVertices();
     void initEdges();
     void initGroup();
+    void initSubgroups();
     void initCalculations();
 
-    bool haveEdge(int v, int w);
+    void calcVtxTrnsSubgroups();
+    void calcEdgeEquivClasses();
+
+    void swapNeighbours(int vertex, int *neighbours) const;
 
-    void startPermutate(std::string factoredPerm, int *result);
-    void permutateVertices(std::string factoredPerm, int *vertices);
-    int permutateVertex(std::string factoredPerm, int vertex);
-    std::string prepareForParsing(const std::string &perm);
-    virtual std::vector<int *> parsePermutation(std::string perm) = 0;
+    /*
+     * Combinadic index of the image of a vertex, respectively of every
+     * vertex, under the point permutation 'perm' of the automorphism group.
+     * 'complement' is isComplementing(perm), computed once per permutation.
+     */
+    int permutateVertex(const Permutation &perm, int vertex, bool complement) const;
+    void permutateVertices(const Permutation &perm, int *images) const;
+    // if 'perm' additionally maps every vertex to its complement
+    virtual bool isComplementing(const Permutation &perm) const = 0;
 
     int m_d;
     int m_k;
+    int m_subgroupMode;
+    Combinadic m_combinadic;
     int m_degree;
-    AutGroup *m_group;
-    std::vector<Edge> m_edges;
+    AutGroup *m_group = nullptr;
+    Adjacency m_adjacency;
     int m_vertexCount;
 
 private:
-    void calcEdgeEquivClasses();
-    void initVertices();
+    bool isCanceled() const;
+    // false if canceled
+    bool enterStage(Stage stage);
 
-    void calcVtxTrnsSubgroups();
-    bool isVtxTrnsSubgroup(int sub);
+    void setEdgeClasses(VtxTrnsSubgroup *sub, const std::vector<int> &classes);
 
-    std::vector<Edge> getEdgesToVertex(int vertex);
+    void restoreFromCache(const GroupCacheData &data);
+    void saveToCache() const;
+
+    bool isVtxTrnsSubgroup(int sub) const;
 
     std::vector<VtxTrnsSubgroup *> m_vtxTrnsSubgroups;
+    bool m_restoredFromCache = false;
+    // only complete results of GAP are cached
+    bool m_subgroupsValid = false;
+    ConstructionControl *m_control;
+    bool m_complete = false;
     std::vector<Vertex> m_vertices;
+    // symmetry blocks and conjugators are created lazily from any thread
+    std::mutex m_subgroupDataMutex;
 };
 
 class AsymHypers : public Hypersimplex {
 public:
-    AsymHypers(int d, int k);
-    ~AsymHypers();
+    AsymHypers(int d, int k, int subgroupMode = 0, ConstructionControl *control = nullptr);
 
-private:
-    virtual std::vector<int *> parsePermutation(std::string perm) override;
+protected:
+    // without 'runInit' a subclass runs the construction stages itself
+    AsymHypers(int d, int k, int subgroupMode, ConstructionControl *control, bool runInit);
 
-    /*
-     * Associates which combinadic vertex is
-     * mapped to which other cominadic vertex.
-     */
-    int *m_genAsymSd_1d = nullptr;
-    int *m_genAsymSd_1d_inv = nullptr;
-    int *m_genAsymSd_12 = nullptr;
+private:
+    virtual bool isComplementing(const Permutation &perm) const override;
 };
 
 class SymHypers : public Hypersimplex {
 public:
-    SymHypers(int d, int k);
-    ~SymHypers();
+    SymHypers(int d, int k, int subgroupMode = 0, ConstructionControl *control = nullptr);
 
-private:
-    virtual std::vector<int *> parsePermutation(std::string perm) override;
+protected:
+    // without 'runInit' a subclass runs the construction stages itself
+    SymHypers(int d, int k, int subgroupMode, ConstructionControl *control, bool runInit);
 
-    /*
-     * Associates which combinadic vertex is
-     * mapped to which other cominadic vertex.
-     */
-    int *m_genSymS2_12 = nullptr;
-    int *m_genSymSd_1d = nullptr;
-    int *m_genSymSd_1d_inv = nullptr;
-    int *m_genSymSd_12 = nullptr;
+private:
+    virtual bool isComplementing(const Permutation &perm) const override;
 };
 
-static bool s_ready = true;
-static Hypersimplex *s_hypers = nullptr;
-
-static void *s_createHypersimplex(int d, int k)
-{
-    if (k <= 0 || d <= 1 || d <= k) {
-        return nullptr;
-    }
-
-    delete s_hypers;
-    s_hypers = nullptr;
-
-    s_ready = false;
-    if (d == 2 * k) {
-        s_hypers = new SymHypers(d, k);
-    } else {
-        s_hypers = new AsymHypers(d, k);
-    }
-    s_ready = true;
-}
-
 #endif // HYPERSIMPLEX_H
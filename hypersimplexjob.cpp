@@ -0,0 +1,90 @@
+/*********************************************************************
+Hypersimplex Representer
+Copyright (C) 2017 Roman Gilg
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#include "hypersimplexjob.h"
+#include "hypersimplex.h"
+
+#include <QtConcurrent/QtConcurrentRun>
+
+HypersimplexJob::HypersimplexJob(int d, int k, int subgroupMode, QObject *parent)
+    : QObject(parent),
+      m_d(d),
+      m_k(k),
+      m_subgroupMode(subgroupMode),
+      m_control([this](int stage) {
+          emit stageStarted(stage, Hypersimplex::StageCount, QString(Hypersimplex::stageName(stage)));
+      })
+{
+    connect(&m_watcher, &QFutureWatcher<Hypersimplex *>::finished, this, &HypersimplexJob::onFinished);
+}
+
+HypersimplexJob::~HypersimplexJob()
+{
+    // the construction uses m_control until it returns
+    m_control.cancel();
+    m_watcher.waitForFinished();
+
+    // deleted before onFinished collected the result
+    if (m_watcher.isStarted() && !m_finished) {
+        m_result = m_watcher.result();
+    }
+    delete m_result;
+}
+
+void HypersimplexJob::start()
+{
+    const int d = m_d;
+    const int k = m_k;
+    const int subgroupMode = m_subgroupMode;
+    ConstructionControl *control = &m_control;
+
+    m_watcher.setFuture(QtConcurrent::run([d, k, subgroupMode, control]() -> Hypersimplex * {
+        if (k <= 0 || d <= 1 || d <= k) {
+            return nullptr;
+        }
+        if (d == 2 * k) {
+            return new SymHypers(d, k, subgroupMode, control);
+        }
+        return new AsymHypers(d, k, subgroupMode, control);
+    }));
+}
+
+void HypersimplexJob::cancel()
+{
+    m_control.cancel();
+}
+
+Hypersimplex *HypersimplexJob::takeResult()
+{
+    Hypersimplex *ret = m_result;
+    m_result = nullptr;
+    return ret;
+}
+
+void HypersimplexJob::onFinished()
+{
+    m_finished = true;
+    m_result = m_watcher.result();
+    if (m_result && (m_control.isCanceled() || !m_result->isComplete())) {
+        delete m_result;
+        m_result = nullptr;
+    }
+
+    emit finished();
+    deleteLater();
+}
@@ -0,0 +1,75 @@
+/*********************************************************************
+Hypersimplex Representer
+Copyright (C) 2017 Roman Gilg
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#ifndef HYPERSIMPLEXJOB_H
+#define HYPERSIMPLEXJOB_H
+
+#include <QFutureWatcher>
+#include <QObject>
+#include <QString>
+
+#include "constructioncontrol.h"
+
+class Hypersimplex;
+
+/*
+ * Constructs a hypersimplex on the global thread pool. A canceled job
+ * stops at the next check of the construction and finishes without
+ * result. Deletes itself after finishing.
+ */
+class HypersimplexJob : public QObject
+{
+    Q_OBJECT
+
+public:
+    HypersimplexJob(int d, int k, int subgroupMode, QObject *parent = nullptr);
+    ~HypersimplexJob();
+
+    void start();
+    void cancel();
+
+    int d() const {
+        return m_d;
+    }
+    int k() const {
+        return m_k;
+    }
+
+    // null if canceled or invalid, the caller takes ownership
+    Hypersimplex *takeResult();
+
+Q_SIGNALS:
+    // emitted from the constructing thread
+    void stageStarted(int stage, int stageCount, const QString &name);
+    void finished();
+
+private Q_SLOTS:
+    void onFinished();
+
+private:
+    int m_d;
+    int m_k;
+    int m_subgroupMode;
+
+    ConstructionControl m_control;
+    QFutureWatcher<Hypersimplex *> m_watcher;
+    Hypersimplex *m_result = nullptr;
+    bool m_finished = false;
+};
+
+#endif // HYPERSIMPLEXJOB_H
@@ -17,7 +17,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *********************************************************************/
 
 #include <QGuiApplication>
+#include <QOpenGLContext>
 #include <QQuickView>
+#include <QSurfaceFormat>
 
 #include "hypersimplex.h"
 #include "backend.h"
@@ -26,6 +28,15 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 int main(int argc, char** argv)
 {
+    if (QOpenGLContext::openGLModuleType() == QOpenGLContext::LibGL) {
+        // instanced drawing needs OpenGL 3.3, Mesa's llvmpipe only has it in core profile
+        QSurfaceFormat format;
+        format.setVersion(3, 3);
+        format.setProfile(QSurfaceFormat::CoreProfile);
+        format.setDepthBufferSize(24);
+        QSurfaceFormat::setDefaultFormat(format);
+    }
+
     QGuiApplication app(argc, argv);
     app.setWindowIcon(QIcon::fromTheme(QStringLiteral("applications-education-mathematics")));
     app.setApplicationName("Hypersimplex Representer");
@@ -0,0 +1,301 @@
+/*********************************************************************
+Hypersimplex Representer
+Copyright (C) 2017 Roman Gilg
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#include "permgroup.h"
+
+#include <cctype>
+
+Permutation identityPermutation(int degree)
+{
+    Permutation ret(degree);
+    for (int i = 0; i < degree; i++) {
+        ret[i] = i;
+    }
+    return ret;
+}
+
+Permutation inversePermutation(const Permutation &perm)
+{
+    Permutation ret(perm.size());
+    for (std::size_t i = 0; i < perm.size(); i++) {
+        ret[perm[i]] = i;
+    }
+    return ret;
+}
+
+Permutation composePermutations(const Permutation &outer, const Permutation &inner)
+{
+    Permutation ret(inner.size());
+    for (std::size_t i = 0; i < inner.size(); i++) {
+        ret[i] = outer[inner[i]];
+    }
+    return ret;
+}
+
+bool isIdentityPermutation(const Permutation &perm)
+{
+    for (std::size_t i = 0; i < perm.size(); i++) {
+        if (perm[i] != (int)i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<Permutation> parseGapGenerators(const std::string &group, int degree)
+{
+    std::vector<Permutation> ret;
+
+    std::size_t pos = group.find('[');
+    if (pos == std::string::npos) {
+        // trivial group "Group(())"
+        return ret;
+    }
+
+    Permutation perm = identityPermutation(degree);
+    std::vector<int> cycle;
+    int number = 0;
+    bool inCycle = false;
+    bool inNumber = false;
+
+    for (pos++; pos < group.size(); pos++) {
+        const char c = group[pos];
+
+        if (std::isdigit(c)) {
+            number = 10 * number + (c - '0');
+            inNumber = true;
+            continue;
+        }
+        if (inNumber && (c == ',' || c == ')')) {
+            cycle.push_back(number - 1);
+            number = 0;
+            inNumber = false;
+        }
+
+        if (c == '(') {
+            inCycle = true;
+            cycle.clear();
+        } else if (c == ')') {
+            inCycle = false;
+            for (std::size_t i = 0; i < cycle.size(); i++) {
+                perm[cycle[i]] = cycle[(i + 1) % cycle.size()];
+            }
+        } else if (!inCycle && (c == ',' || c == ']')) {
+            ret.push_back(perm);
+            perm = identityPermutation(degree);
+            if (c == ']') {
+                break;
+            }
+        }
+    }
+    return ret;
+}
+
+PermGroup::PermGroup(int degree, std::vector<Permutation> generators)
+    : m_degree(degree)
+{
+    for (auto &gen : generators) {
+        if (!isIdentityPermutation(gen)) {
+            m_generators.push_back(gen);
+        }
+    }
+    schreierSims();
+}
+
+PermGroup PermGroup::fromGap(const std::string &group, int degree)
+{
+    return PermGroup(degree, parseGapGenerators(group, degree));
+}
+
+void PermGroup::calcOrbit(Level &level)
+{
+    level.transversal.assign(m_degree, Permutation());
+    level.transversalInv.assign(m_degree, Permutation());
+    level.orbit.clear();
+
+    level.transversal[level.base] = identityPermutation(m_degree);
+    level.transversalInv[level.base] = level.transversal[level.base];
+    level.orbit.push_back(level.base);
+
+    for (std::size_t i = 0; i < level.orbit.size(); i++) {
+        const int p = level.orbit[i];
+        for (auto &gen : level.generators) {
+            const int q = gen[p];
+            if (!level.transversal[q].empty()) {
+                continue;
+            }
+            level.transversal[q] = composePermutations(gen, level.transversal[p]);
+            level.transversalInv[q] = inversePermutation(level.transversal[q]);
+            level.orbit.push_back(q);
+        }
+    }
+}
+
+void PermGroup::addBasePoint(const Permutation &movingPerm)
+{
+    Level level;
+    level.base = 0;
+    while (movingPerm[level.base] == level.base) {
+        level.base++;
+    }
+    m_levels.push_back(level);
+}
+
+/*
+ * Strips 'perm' through the transversals starting at 'startLevel'.
+ * Returns the level at which this was not possible anymore or the level
+ * count if all levels were passed. 'perm' is replaced by the residue.
+ */
+int PermGroup::sift(Permutation &perm, int startLevel) const
+{
+    const int levelCount = m_levels.size();
+
+    for (int l = startLevel; l < levelCount; l++) {
+        const int beta = perm[m_levels[l].base];
+        if (m_levels[l].transversal[beta].empty()) {
+            return l;
+        }
+        perm = composePermutations(m_levels[l].transversalInv[beta], perm);
+    }
+    return levelCount;
+}
+
+void PermGroup::schreierSims()
+{
+    m_levels.clear();
+
+    // initial base, such that no generator fixes all base points
+    for (auto &gen : m_generators) {
+        bool movesBase = false;
+        for (auto &level : m_levels) {
+            if (gen[level.base] != level.base) {
+                movesBase = true;
+                break;
+            }
+        }
+        if (!movesBase) {
+            addBasePoint(gen);
+        }
+    }
+
+    for (std::size_t i = 0; i < m_levels.size(); i++) {
+        for (auto &gen : m_generators) {
+            bool fixesPrevious = true;
+            for (std::size_t j = 0; j < i; j++) {
+                if (gen[m_levels[j].base] != m_levels[j].base) {
+                    fixesPrevious = false;
+                    break;
+                }
+            }
+            if (fixesPrevious) {
+                m_levels[i].generators.push_back(gen);
+            }
+        }
+        calcOrbit(m_levels[i]);
+    }
+
+    int i = (int)m_levels.size() - 1;
+    while (i >= 0) {
+        bool extended = false;
+
+        for (std::size_t o = 0; o < m_levels[i].orbit.size() && !extended; o++) {
+            const int p = m_levels[i].orbit[o];
+
+            for (std::size_t g = 0; g < m_levels[i].generators.size(); g++) {
+                const Level &level = m_levels[i];
+                const Permutation &gen = level.generators[g];
+
+                // Schreier generator, fixes the base points up to level i
+                Permutation schreierGen = composePermutations(level.transversalInv[gen[p]],
+                                                              composePermutations(gen, level.transversal[p]));
+                const int j = sift(schreierGen, i + 1);
+                if (j == (int)m_levels.size() && isIdentityPermutation(schreierGen)) {
+                    continue;
+                }
+
+                if (j == (int)m_levels.size()) {
+                    addBasePoint(schreierGen);
+                }
+                for (int l = i + 1; l <= j; l++) {
+                    m_levels[l].generators.push_back(schreierGen);
+                    calcOrbit(m_levels[l]);
+                }
+                i = j;
+                extended = true;
+                break;
+            }
+        }
+        if (!extended) {
+            i--;
+        }
+    }
+}
+
+uint64_t PermGroup::order() const
+{
+    uint64_t ret = 1;
+    for (auto &level : m_levels) {
+        ret *= level.orbit.size();
+    }
+    return ret;
+}
+
+bool PermGroup::contains(const Permutation &perm) const
+{
+    Permutation residue = perm;
+    return sift(residue, 0) == (int)m_levels.size() && isIdentityPermutation(residue);
+}
+
+void PermGroup::collectElements(std::size_t level, const Permutation &prefix, std::vector<Permutation> &out) const
+{
+    if (level == m_levels.size()) {
+        out.push_back(prefix);
+        return;
+    }
+    for (auto p : m_levels[level].orbit) {
+        collectElements(level + 1, composePermutations(prefix, m_levels[level].transversal[p]), out);
+    }
+}
+
+std::vector<Permutation> PermGroup::elements() const
+{
+    std::vector<Permutation> ret;
+    ret.reserve(order());
+    collectElements(0, identityPermutation(m_degree), ret);
+    return ret;
+}
+
+std::vector<int> PermGroup::orbit(int point) const
+{
+    std::vector<bool> hit(m_degree, false);
+    std::vector<int> ret;
+
+    hit[point] = true;
+    ret.push_back(point);
+
+    for (std::size_t i = 0; i < ret.size(); i++) {
+        for (auto &gen : m_generators) {
+            const int q = gen[ret[i]];
+            if (!hit[q]) {
+                hit[q] = true;
+                ret.push_back(q);
+            }
+        }
+    }
+    return ret;
+}
@@ -0,0 +1,87 @@
+/*********************************************************************
+Hypersimplex Representer
+Copyright (C) 2017 Roman Gilg
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#ifndef PERMGROUP_H
+#define PERMGROUP_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Permutation of the points 0, ..., n-1 in image notation:
+ * point i is mapped to perm[i].
+ */
+typedef std::vector<int> Permutation;
+
+Permutation identityPermutation(int degree);
+Permutation inversePermutation(const Permutation &perm);
+// first apply 'inner', then 'outer'
+Permutation composePermutations(const Permutation &outer, const Permutation &inner);
+bool isIdentityPermutation(const Permutation &perm);
+
+/*
+ * Parses a permutation group as printed by GAP, e.g. "Group([(1,2,3),(1,2)])"
+ * or "Group(())". GAP counts points from 1, the returned generators from 0.
+ */
+std::vector<Permutation> parseGapGenerators(const std::string &group, int degree);
+
+/*
+ * Permutation group given by generators. A base and strong generating set
+ * is computed with the Schreier-Sims algorithm on construction.
+ */
+class PermGroup {
+public:
+    PermGroup(int degree, std::vector<Permutation> generators);
+
+    static PermGroup fromGap(const std::string &group, int degree);
+
+    int degree() const {
+        return m_degree;
+    }
+    const std::vector<Permutation> &generators() const {
+        return m_generators;
+    }
+
+    uint64_t order() const;
+    bool contains(const Permutation &perm) const;
+    std::vector<Permutation> elements() const;
+    std::vector<int> orbit(int point) const;
+
+private:
+    struct Level {
+        int base;
+        std::vector<Permutation> generators;
+        // transversal[p] maps base to p, empty if p is not in the orbit
+        std::vector<Permutation> transversal;
+        std::vector<Permutation> transversalInv;
+        std::vector<int> orbit;
+    };
+
+    void schreierSims();
+    void calcOrbit(Level &level);
+    int sift(Permutation &perm, int startLevel) const;
+    void addBasePoint(const Permutation &movingPerm);
+    void collectElements(std::size_t level, const Permutation &prefix, std::vector<Permutation> &out) const;
+
+    int m_degree;
+    std::vector<Permutation> m_generators;
+    std::vector<Level> m_levels;
+};
+
+#endif // PERMGROUP_H
@@ -19,6 +19,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "schlegel.h"
 
 #include "hypersimplex.h"
+#include "trace.h"
 
 #include <algorithm>
 #include <iostream>
@@ -110,6 +111,8 @@ static MatrixXd gramSchmidt(const MatrixXd &basis)
 
 std::vector<VectorXd> Schlegel::getDiagram(int &error) const
 {
+    TRACE_SCOPE("Schlegel::getDiagram");
+
     facet_pair fp = m_hypers->getFacetPair(m_facetPairIndex);
 
     int dim = m_hypers->d() - 1;
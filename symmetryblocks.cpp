@@ -0,0 +1,319 @@
+/*********************************************************************
+Hypersimplex Representer
+Copyright (C) 2017 Roman Gilg
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#include "symmetryblocks.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+
+#include <eigen3/Eigen/Eigenvalues>
+#include <eigen3/Eigen/LU>
+
+#include <QDebug>
+
+using namespace Eigen;
+
+// the orbital of every vertex pair is held in memory
+static const int s_maxVertexCount = 4096;
+static const int s_maxOrbitalCount = 512;
+
+static int findOrbitalRoot(std::vector<int> &parent, int pair)
+{
+    while (parent[pair] != pair) {
+        parent[pair] = parent[parent[pair]];
+        pair = parent[pair];
+    }
+    return pair;
+}
+
+SymmetryBlocks::SymmetryBlocks(int vertexCount, const std::vector<std::vector<int> > &generators)
+    : m_vertexCount(vertexCount)
+{
+    TRACE_SCOPE("SymmetryBlocks::SymmetryBlocks");
+
+    if (vertexCount > s_maxVertexCount) {
+        return;
+    }
+
+    std::vector<int> orbitals;
+    if (!calcOrbitals(generators, orbitals)) {
+        return;
+    }
+
+    std::vector<VectorXd> idempotents;
+    std::vector<int> irrepDims;
+    if (!calcIdempotents(orbitals, idempotents, irrepDims)) {
+        return;
+    }
+
+    for (std::size_t c = 0; c < idempotents.size(); c++) {
+        // the trace of the projection is its rank
+        const int size = std::round(m_vertexCount * idempotents[c](0));
+
+        Block block;
+        block.irrepDim = irrepDims[c];
+        if (!calcBasis(orbitals, idempotents[c], size, block.basis)) {
+            m_blocks.clear();
+            return;
+        }
+        m_blocks.push_back(block);
+    }
+    m_valid = true;
+}
+
+/*
+ * Joins every vertex pair with its images under the generators. Since the
+ * group is transitive every orbital meets the pairs (0, w), so those give
+ * the smallest root of each orbital and its number.
+ */
+bool SymmetryBlocks::calcOrbitals(const std::vector<std::vector<int> > &generators, std::vector<int> &orbitals)
+{
+    const int n = m_vertexCount;
+    std::vector<int> parent(n * n);
+    std::iota(parent.begin(), parent.end(), 0);
+
+    for (auto &gen : generators) {
+        for (int v = 0; v < n; v++) {
+            for (int w = 0; w < n; w++) {
+                const int root = findOrbitalRoot(parent, v * n + w);
+                const int imgRoot = findOrbitalRoot(parent, gen[v] * n + gen[w]);
+                if (root < imgRoot) {
+                    parent[imgRoot] = root;
+                } else if (imgRoot < root) {
+                    parent[root] = imgRoot;
+                }
+            }
+        }
+    }
+
+    for (int pair = 0; pair < n * n; pair++) {
+        parent[pair] = findOrbitalRoot(parent, pair);
+    }
+
+    std::vector<int> orbitalOfRoot(n, -1);
+    m_representatives.clear();
+    for (int w = 0; w < n; w++) {
+        if (parent[w] == w) {
+            orbitalOfRoot[w] = m_representatives.size();
+            m_representatives.push_back(w);
+        }
+    }
+    m_orbitalCount = m_representatives.size();
+    if (m_orbitalCount > s_maxOrbitalCount) {
+        return false;
+    }
+
+    for (int pair = 0; pair < n * n; pair++) {
+        parent[pair] = orbitalOfRoot[parent[pair]];
+    }
+    orbitals.swap(parent);
+
+    m_paired.resize(m_orbitalCount);
+    for (int i = 0; i < m_orbitalCount; i++) {
+        m_paired[i] = orbitals[m_representatives[i] * n];
+    }
+    return true;
+}
+
+/*
+ * Finds the central primitive idempotents of the orbital algebra, given as
+ * coefficients of the orbital matrices.
+ *
+ * The center is the part of the algebra commuting with two random elements.
+ * A random symmetric central element acts as a different scalar on every
+ * component, so the components are the eigenspaces of its left regular
+ * representation. That one is symmetric in the trace form, which weights
+ * every orbital with the size of its suborbit.
+ */
+bool SymmetryBlocks::calcIdempotents(const std::vector<int> &orbitals,
+                                     std::vector<VectorXd> &idempotents, std::vector<int> &irrepDims) const
+{
+    const int n = m_vertexCount;
+    const int r = m_orbitalCount;
+
+    // deterministic, so the same subgroup always gives the same bases
+    std::mt19937 gen(5489u);
+    std::uniform_real_distribution<double> dist(-1., 1.);
+    auto randomVector = [&gen, &dist](int size) {
+        VectorXd v(size);
+        for (int i = 0; i < size; i++) {
+            v(i) = dist(gen);
+        }
+        return v;
+    };
+
+    /*
+     * Coefficient k of (z * b - b * z) is the entry (0, u_k). Integer test
+     * elements keep the entries exact, so commuting parts cancel to zero.
+     */
+    std::uniform_int_distribution<int> intDist(1, 1000);
+    const int *firstRow = &orbitals[0];
+    MatrixXd commutators = MatrixXd::Zero(2 * r, r);
+    for (int t = 0; t < 2; t++) {
+        VectorXd b(r);
+        for (int i = 0; i < r; i++) {
+            b(i) = intDist(gen);
+        }
+        for (int k = 0; k < r; k++) {
+            for (int w = 0; w < n; w++) {
+                const int a = firstRow[w];
+                const int c = orbitals[w * n + m_representatives[k]];
+                commutators(t * r + k, a) += b(c);
+                commutators(t * r + k, c) -= b(a);
+            }
+        }
+    }
+    FullPivLU<MatrixXd> lu(commutators);
+    lu.setThreshold(1e-9);
+    const MatrixXd center = lu.kernel();
+    const int centerDim = center.cols();
+
+    VectorXd z = center * randomVector(centerDim);
+    for (int i = 0; i < r; i++) {
+        z(i) = z(m_paired[i]) = 0.5 * (z(i) + z(m_paired[i]));
+    }
+
+    VectorXd suborbitSize = VectorXd::Zero(r);
+    for (int w = 0; w < n; w++) {
+        suborbitSize(firstRow[w]) += 1.;
+    }
+    const VectorXd scale = suborbitSize.cwiseSqrt();
+
+    // z * A_j = sum_k regular(k, j) * A_k
+    MatrixXd regular = MatrixXd::Zero(r, r);
+    for (int k = 0; k < r; k++) {
+        for (int w = 0; w < n; w++) {
+            regular(k, orbitals[w * n + m_representatives[k]]) += z(firstRow[w]);
+        }
+    }
+    MatrixXd symRegular = scale.asDiagonal() * regular * scale.cwiseInverse().asDiagonal();
+    symRegular = 0.5 * (symRegular + symRegular.transpose()).eval();
+
+    SelfAdjointEigenSolver<MatrixXd> solver(symRegular);
+    if (solver.info() != Success) {
+        return false;
+    }
+    const VectorXd &omega = solver.eigenvalues();
+    const MatrixXd &q = solver.eigenvectors();
+    const double tolerance = 1e-8 * std::max(1., omega.cwiseAbs().maxCoeff());
+
+    // the identity is the orbital of (0, 0), in scaled coordinates
+    VectorXd identity = VectorXd::Zero(r);
+    identity(0) = scale(0);
+
+    // complex components contribute two dimensions to the center
+    int foundCenterDim = 0;
+    int start = 0;
+    while (start < r) {
+        int end = start + 1;
+        while (end < r && omega(end) - omega(end - 1) < tolerance) {
+            end++;
+        }
+        const int count = end - start;
+        const MatrixXd cluster = q.middleCols(start, count);
+
+        VectorXd idempotent = cluster * (cluster.transpose() * identity);
+        idempotent = idempotent.cwiseQuotient(scale);
+
+        /*
+         * The component's part of the algebra is a full matrix algebra of
+         * degree m over the reals, complex numbers or quaternions. The trace
+         * of the pairing map on it separates these cases.
+         */
+        double pairingTrace = 0;
+        for (int j = start; j < end; j++) {
+            for (int i = 0; i < r; i++) {
+                pairingTrace += q(i, j) * q(m_paired[i], j);
+            }
+        }
+        const int trace = std::round(pairingTrace);
+        int m;
+        if (trace > 0) {
+            m = trace;
+        } else if (trace < 0) {
+            m = -trace / 2;
+        } else {
+            m = std::round(std::sqrt(count / 2.));
+        }
+        foundCenterDim += trace ? 1 : 2;
+
+        const double size = n * idempotent(0);
+        const int roundedSize = std::round(size);
+        if (m <= 0 || std::abs(size - roundedSize) > 1e-6 || roundedSize % m) {
+            qDebug() << "Symmetry blocks: inconsistent component of dimension" << size;
+            return false;
+        }
+        idempotents.push_back(idempotent);
+        irrepDims.push_back(roundedSize / m);
+        start = end;
+    }
+
+    if (foundCenterDim != centerDim) {
+        qDebug() << "Symmetry blocks: components span" << foundCenterDim
+                 << "center dimensions instead of" << centerDim;
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Orthonormal basis of the image of the projection with the given orbital
+ * coefficients. Columns of the projection are taken greedily by largest
+ * remaining norm, which for a projection is its residual diagonal.
+ */
+bool SymmetryBlocks::calcBasis(const std::vector<int> &orbitals, const VectorXd &idempotent,
+                               int size, MatrixXd &basis) const
+{
+    const int n = m_vertexCount;
+    basis.resize(n, size);
+    VectorXd residual = VectorXd::Constant(n, idempotent(0));
+    VectorXd col(n);
+
+    for (int j = 0; j < size; j++) {
+        int pivot;
+        residual.maxCoeff(&pivot);
+
+        // projections in the algebra are symmetric, so the row will do
+        const int *row = &orbitals[pivot * n];
+        for (int w = 0; w < n; w++) {
+            col(w) = idempotent(row[w]);
+        }
+        for (int pass = 0; pass < 2; pass++) {
+            col -= basis.leftCols(j) * (basis.leftCols(j).transpose() * col);
+        }
+        const double norm = col.norm();
+        if (norm < 1e-8) {
+            return false;
+        }
+        basis.col(j) = col / norm;
+        residual -= basis.col(j).cwiseAbs2();
+    }
+    return true;
+}
+
+std::size_t SymmetryBlocks::memoryUsage() const
+{
+    std::size_t bytes = (m_representatives.size() + m_paired.size()) * sizeof(int);
+    for (auto &block : m_blocks) {
+        bytes += block.basis.size() * sizeof(double);
+    }
+    return bytes;
+}
@@ -0,0 +1,78 @@
+/*********************************************************************
+Hypersimplex Representer
+Copyright (C) 2017 Roman Gilg
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#ifndef SYMMETRYBLOCKS_H
+#define SYMMETRYBLOCKS_H
+
+#include <vector>
+
+#include <eigen3/Eigen/Dense>
+
+/*
+ * Decomposition of the vertex space into the isotypic components of a
+ * vertex-transitive permutation group.
+ *
+ * Every matrix invariant under the group maps each component into itself,
+ * so it can be diagonalised block by block in the orthonormal bases found
+ * here. Inside a block all its eigenspaces have a dimension divisible by
+ * the dimension of the block's real irreducible submodules.
+ *
+ * The components are read off the orbital algebra of the group, which
+ * needs the orbital of every vertex pair. Very large vertex sets or
+ * groups with too many orbitals are rejected.
+ */
+class SymmetryBlocks {
+public:
+    struct Block {
+        // one orthonormal column per dimension of the component
+        Eigen::MatrixXd basis;
+        int irrepDim;
+    };
+
+    SymmetryBlocks(int vertexCount, const std::vector<std::vector<int> > &generators);
+
+    bool isValid() const {
+        return m_valid;
+    }
+    const std::vector<Block> &blocks() const {
+        return m_blocks;
+    }
+    int orbitalCount() const {
+        return m_orbitalCount;
+    }
+    // approximate heap memory of the bases and orbital tables, in bytes
+    std::size_t memoryUsage() const;
+
+private:
+    bool calcOrbitals(const std::vector<std::vector<int> > &generators, std::vector<int> &orbitals);
+    bool calcIdempotents(const std::vector<int> &orbitals,
+                         std::vector<Eigen::VectorXd> &idempotents, std::vector<int> &irrepDims) const;
+    bool calcBasis(const std::vector<int> &orbitals, const Eigen::VectorXd &idempotent,
+                   int size, Eigen::MatrixXd &basis) const;
+
+    int m_vertexCount;
+    int m_orbitalCount = 0;
+    // first vertex w with (0, w) in the orbital, and the orbital of (w, 0)
+    std::vector<int> m_representatives;
+    std::vector<int> m_paired;
+
+    std::vector<Block> m_blocks;
+    bool m_valid = false;
+};
+
+#endif // SYMMETRYBLOCKS_H
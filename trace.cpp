@@ -0,0 +1,126 @@
+/*********************************************************************
+Hypersimplex Representer
+Copyright (C) 2017 Roman Gilg
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#include "trace.h"
+
+#ifdef HYPERSIMPLEX_TRACE
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+struct TraceEvent {
+    const char *name;
+    // 'X' for a scope, 'C' for a counter
+    char phase;
+    int tid;
+    int64_t start;
+    int64_t duration;
+    double value;
+};
+
+class TraceRecorder {
+public:
+    TraceRecorder()
+        : m_epoch(std::chrono::steady_clock::now())
+    {}
+    ~TraceRecorder() {
+        const char *file = getenv("HYPERSIMPLEX_TRACE_FILE");
+        if (!file) {
+            return;
+        }
+        std::ofstream out(file);
+        write(out);
+    }
+
+    int64_t now() const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - m_epoch).count();
+    }
+
+    void add(const TraceEvent &event) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_events.push_back(event);
+    }
+
+    void write(std::ostream &out) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        for (std::size_t i = 0; i < m_events.size(); i++) {
+            const TraceEvent &event = m_events[i];
+            out << (i ? ",\n" : "\n")
+                << "{\"name\":\"" << event.name << "\",\"ph\":\"" << event.phase
+                << "\",\"pid\":1,\"tid\":" << event.tid << ",\"ts\":" << event.start;
+            if (event.phase == 'X') {
+                out << ",\"dur\":" << event.duration;
+            } else {
+                out << ",\"args\":{\"value\":" << event.value << "}";
+            }
+            out << "}";
+        }
+        out << "\n]}\n";
+    }
+
+private:
+    const std::chrono::steady_clock::time_point m_epoch;
+    std::mutex m_mutex;
+    std::vector<TraceEvent> m_events;
+};
+
+TraceRecorder &recorder()
+{
+    static TraceRecorder s_recorder;
+    return s_recorder;
+}
+
+int threadId()
+{
+    static std::atomic<int> s_nextId(0);
+    thread_local int id = s_nextId++;
+    return id;
+}
+
+}
+
+int64_t Trace::now()
+{
+    return recorder().now();
+}
+
+void Trace::addScope(const char *name, int64_t start, int64_t duration)
+{
+    recorder().add(TraceEvent{name, 'X', threadId(), start, duration, 0.});
+}
+
+void Trace::addCounter(const char *name, double value)
+{
+    recorder().add(TraceEvent{name, 'C', threadId(), recorder().now(), 0, value});
+}
+
+void Trace::writeChromeTrace(std::ostream &out)
+{
+    recorder().write(out);
+}
+
+#endif // HYPERSIMPLEX_TRACE
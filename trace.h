@@ -0,0 +1,75 @@
+/*********************************************************************
+Hypersimplex Representer
+Copyright (C) 2017 Roman Gilg
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+/*
+ * Scoped timers and counters around the expensive stages, recorded as
+ * Chrome trace events (chrome://tracing, Perfetto). Only compiled in with
+ * HYPERSIMPLEX_TRACE defined, otherwise the macros expand to nothing.
+ *
+ * The trace is written at exit to $HYPERSIMPLEX_TRACE_FILE, if set.
+ * Names must be string literals.
+ */
+
+#ifdef HYPERSIMPLEX_TRACE
+
+#include <cstdint>
+#include <ostream>
+
+class Trace {
+public:
+    // microseconds since the first trace event
+    static int64_t now();
+
+    static void addScope(const char *name, int64_t start, int64_t duration);
+    static void addCounter(const char *name, double value);
+
+    static void writeChromeTrace(std::ostream &out);
+};
+
+class TraceScope {
+public:
+    explicit TraceScope(const char *name)
+        : m_name(name),
+          m_start(Trace::now())
+    {}
+    ~TraceScope() {
+        Trace::addScope(m_name, m_start, Trace::now() - m_start);
+    }
+
+private:
+    const char *m_name;
+    int64_t m_start;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+#define TRACE_COUNTER(name, value) Trace::addCounter(name, value)
+
+#else
+
+#define TRACE_SCOPE(name)
+#define TRACE_COUNTER(name, value) do {} while (0)
+
+#endif // HYPERSIMPLEX_TRACE
+
+#endif // TRACE_H
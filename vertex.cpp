@@ -22,86 +22,84 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <cmath>
 
-Vertex::Vertex(int combIndex, std::vector<int> comps, int k)
-    : m_combIndex(combIndex),
-      m_comps(comps),
-      m_dim(comps.size()),
-      m_k(k)
-{
-}
-
 Vertex::Vertex(int combIndex, int dim, int k)
-    : m_combIndex(combIndex),
-      m_dim(dim),
-      m_k(k)
+    : m_dim(dim),
+      m_k(k),
+      m_combIndex(combIndex)
 {
-    int comps[dim] = {0};
-    combinadicComb(k, combIndex, comps);
+    Combinadic combinadic(dim, k);
 
-    m_comps = std::vector<int>(comps, comps + dim);
-}
-
-Vertex::Vertex(std::vector<int> comps, int k)
-    : m_comps(comps),
-      m_dim(comps.size()),
-      m_k(k)
-{
+    if (dim <= 64) {
+        m_bits = combinadic.unrankMask(combIndex);
+    } else {
+        std::vector<int> comps(dim);
+        combinadic.unrank(combIndex, comps.data());
+        setComps(comps.data());
+    }
 }
 
-Vertex::Vertex(const Vertex &b)
-    : m_combIndex(b.combIndex()),
-      m_comps(b.comps()),
-      m_dim(b.comps().size()),
-      m_k(b.k())
+Vertex::Vertex(int combIndex, uint64_t mask, int dim, int k)
+    : m_dim(dim),
+      m_k(k),
+      m_combIndex(combIndex),
+      m_bits(mask)
 {
 }
 
-int Vertex::operator*(const Vertex &b) const
+Vertex::Vertex(std::vector<int> comps, int k)
+    : m_dim(comps.size()),
+      m_k(k)
 {
-    auto compsB = b.comps();
-    int sum = 0;
-    for (int i = 0; i < m_comps.size(); i++) {
-        sum += m_comps[i] * compsB[i];
+    int compSum = 0;
+    bool isVertex = true;
+    for (auto c : comps) {
+        compSum += c;
+        if (c != 0 && c != 1) {
+            isVertex = false;
+        }
+    }
+    if (!isVertex) {
+        return;
+    }
+    setComps(comps.data());
+    if (compSum == k) {
+        m_combIndex = Combinadic(m_dim, k).rank(comps.data());
     }
-    return sum;
 }
 
-Vertex Vertex::operator+(const Vertex &b) const
+void Vertex::setComps(const int *comps)
 {
-    std::vector<int> comps;
-    auto compsB = b.comps();
-    auto compSum = 0;
-    bool isVertex = true;
-    for (int i = 0; i < m_comps.size(); i++) {
-        auto c = m_comps[i] + compsB[i];
-        compSum += c;
-        if (c != 0 || c!= 1) {
-            isVertex = false;
+    m_bits = 0;
+    m_highBits.assign((m_dim - 1) / 64, 0);
+
+    for (int i = 0; i < m_dim; i++) {
+        if (!comps[i]) {
+            continue;
+        }
+        if (i < 64) {
+            m_bits |= uint64_t(1) << i;
+        } else {
+            m_highBits[i / 64 - 1] |= uint64_t(1) << (i % 64);
         }
-        comps.push_back(c);
     }
-    return createVertex(comps, compSum, isVertex);
 }
 
-Vertex Vertex::operator-(const Vertex &b) const
+std::vector<int> Vertex::comps() const
 {
-    return operator+(-b);
+    std::vector<int> ret(m_dim);
+    for (int i = 0; i < m_dim; i++) {
+        ret[i] = operator[](i);
+    }
+    return ret;
 }
 
-Vertex Vertex::operator-() const
+int Vertex::operator*(const Vertex &b) const
 {
-    std::vector<int> comps;
-    int compSum = 0;
-    bool isVertex = true;
-    for (int i = 0; i < m_comps.size(); i++) {
-        auto c = - m_comps[i];
-        compSum += c;
-        if (c != 0 || c!= 1) {
-            isVertex = false;
-        }
-        comps.push_back(c);
+    int sum = __builtin_popcountll(m_bits & b.m_bits);
+    for (std::size_t i = 0; i < m_highBits.size(); i++) {
+        sum += __builtin_popcountll(m_highBits[i] & b.m_highBits[i]);
     }
-    return createVertex(comps, compSum, isVertex);
+    return sum;
 }
 
 double Vertex::len() const
@@ -109,12 +107,3 @@ double Vertex::len() const
     auto scalarPr = (*this) * (*this);
     return std::sqrt(scalarPr);
 }
-
-Vertex Vertex::createVertex(std::vector<int> comps, int compSum, bool isVertex) const
-{
-    if (!isVertex || compSum != m_k) {
-        return Vertex(-1, comps, m_k);
-    } else {
-        return Vertex(comps, m_k);
-    }
-}
@@ -19,22 +19,33 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef VERTEX_H
 #define VERTEX_H
 
+#include <cstdint>
 #include <vector>
 
+/*
+ * Vertex of the hypersimplex, i.e. a 0/1 vector with k ones.
+ *
+ * The components are stored as bitmask with bit i for component i. Up to
+ * dimension 64 this is a single word, above the remaining words are
+ * kept in m_highBits.
+ */
 class Vertex {
 public:
-    Vertex(int combIndex, std::vector<int> comps, int k);
     Vertex(int combIndex, int dim, int k);
+    Vertex(int combIndex, uint64_t mask, int dim, int k);
     Vertex(std::vector<int> comps, int k);
-    Vertex(const Vertex &b);
 
-    inline bool operator==(const Vertex &b) { return m_combIndex == b.combIndex(); }
-    inline bool operator!=(const Vertex &b){ return !(*this == b); }
+    inline bool operator==(const Vertex &b) const {
+        return m_bits == b.m_bits && m_highBits == b.m_highBits;
+    }
+    inline bool operator!=(const Vertex &b) const { return !(*this == b); }
     int operator*(const Vertex &b) const;
-    Vertex operator+(const Vertex &b) const;
-    Vertex operator-(const Vertex &b) const;
-    Vertex operator-() const;
-    int operator[](const int index) const {return m_comps[index];}
+    int operator[](const int index) const {
+        if (index < 64) {
+            return (m_bits >> index) & 1;
+        }
+        return (m_highBits[index / 64 - 1] >> (index % 64)) & 1;
+    }
 
     bool isVertex() const {
         return m_combIndex != -1;
@@ -43,11 +54,19 @@ public:
     int combIndex() const {
         return m_combIndex;
     }
-    std::vector<int> comps() const {
-        return m_comps;
+    uint64_t mask() const {
+        return m_bits;
     }
+    bool isWide() const {
+        return !m_highBits.empty();
+    }
+    std::vector<int> comps() const;
     std::vector<double> compsAsDouble() const {
-        return std::vector<double>(m_comps.begin(), m_comps.end());
+        auto c = comps();
+        return std::vector<double>(c.begin(), c.end());
+    }
+    int dim() const {
+        return m_dim;
     }
     int k() const {
         return m_k;
@@ -55,12 +74,13 @@ public:
     double len() const;
 
 private:
-    Vertex createVertex(std::vector<int> comps, int compSum, bool isVertex) const;
+    void setComps(const int *comps);
 
     int m_dim;
     int m_k;
     int m_combIndex = -1;
-    std::vector<int> m_comps;
+    uint64_t m_bits = 0;
+    std::vector<uint64_t> m_highBits;
 };
 
 #endif // VERTEX_H
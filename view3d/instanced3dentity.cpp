@@ -0,0 +1,80 @@
+/*********************************************************************
+Hypersimplex Representer
+Copyright (C) 2017 Roman Gilg
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#include "instanced3dentity.h"
+#include "instancedmaterial.h"
+
+void Instanced3DEntity::pack(const Instance &instance, float *out)
+{
+    out[0] = instance.translation.x();
+    out[1] = instance.translation.y();
+    out[2] = instance.translation.z();
+    out[3] = instance.rotation.x();
+    out[4] = instance.rotation.y();
+    out[5] = instance.rotation.z();
+    out[6] = instance.rotation.scalar();
+    out[7] = instance.length;
+}
+
+Instanced3DEntity::Instanced3DEntity(Qt3DRender::QGeometry *geometry,
+                                     Qt3DRender::QBuffer *instanceBuffer,
+                                     const QColor &color, QNode *parent)
+    : Qt3DCore::QEntity(parent),
+      m_geometry(geometry)
+{
+    m_geometry->setParent(this);
+
+    auto addInstanceAttribute = [this, instanceBuffer](const char *name, uint size, int offset) {
+        auto attribute = new Qt3DRender::QAttribute(m_geometry);
+        attribute->setName(QString::fromLatin1(name));
+        attribute->setAttributeType(Qt3DRender::QAttribute::VertexAttribute);
+        attribute->setVertexBaseType(Qt3DRender::QAttribute::Float);
+        attribute->setVertexSize(size);
+        attribute->setByteOffset(offset * sizeof(float));
+        attribute->setByteStride(FloatsPerInstance * sizeof(float));
+        attribute->setDivisor(1);
+        attribute->setBuffer(instanceBuffer);
+        m_geometry->addAttribute(attribute);
+        m_attributes.push_back(std::make_pair(attribute, offset));
+    };
+    addInstanceAttribute("instanceTranslation", 3, 0);
+    addInstanceAttribute("instanceRotation", 4, 3);
+    addInstanceAttribute("instanceLength", 1, 7);
+
+    m_renderer = new Qt3DRender::QGeometryRenderer(this);
+    m_renderer->setGeometry(m_geometry);
+    m_renderer->setPrimitiveType(Qt3DRender::QGeometryRenderer::Triangles);
+    m_renderer->setInstanceCount(0);
+
+    m_material = new InstancedMaterial(color, this);
+
+    addComponent(m_renderer);
+    addComponent(m_material);
+    setEnabled(false);
+}
+
+void Instanced3DEntity::setInstanceRange(int first, int count)
+{
+    for (auto &attr : m_attributes) {
+        attr.first->setByteOffset((first * FloatsPerInstance + attr.second) * sizeof(float));
+    }
+    m_renderer->setInstanceCount(count);
+
+    // nothing to draw without instances
+    setEnabled(count > 0);
+}
@@ -0,0 +1,69 @@
+/*********************************************************************
+Hypersimplex Representer
+Copyright (C) 2017 Roman Gilg
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#ifndef INSTANCED3DENTITY_H
+#define INSTANCED3DENTITY_H
+
+#include <utility>
+#include <vector>
+
+#include <Qt3DCore/QEntity>
+#include <Qt3DRender/QAttribute>
+#include <Qt3DRender/QBuffer>
+#include <Qt3DRender/QGeometry>
+#include <Qt3DRender/QGeometryRenderer>
+
+#include <QColor>
+#include <QQuaternion>
+#include <QVector3D>
+
+class InstancedMaterial;
+
+/*
+ * Draws one mesh geometry for many instances in a single call. An instance
+ * is the mesh stretched along its y axis, rotated and translated. The
+ * instances are a range of a buffer that other entities may share, so all
+ * of them are updated by a single write.
+ */
+class Instanced3DEntity : public Qt3DCore::QEntity {
+public:
+    struct Instance {
+        QVector3D translation;
+        QQuaternion rotation;
+        float length;
+    };
+    // translation, rotation (x, y, z, scalar), length
+    static const int FloatsPerInstance = 8;
+    static void pack(const Instance &instance, float *out);
+
+    // takes ownership of the geometry
+    Instanced3DEntity(Qt3DRender::QGeometry *geometry, Qt3DRender::QBuffer *instanceBuffer,
+                      const QColor &color, QNode *parent = nullptr);
+
+    // instances 'first' to 'first + count - 1' of the buffer
+    void setInstanceRange(int first, int count);
+
+private:
+    Qt3DRender::QGeometry *m_geometry;
+    Qt3DRender::QGeometryRenderer *m_renderer;
+    InstancedMaterial *m_material;
+    // offsets in floats within an instance
+    std::vector<std::pair<Qt3DRender::QAttribute *, int> > m_attributes;
+};
+
+#endif // INSTANCED3DENTITY_H
@@ -0,0 +1,66 @@
+/*********************************************************************
+Hypersimplex Representer
+Copyright (C) 2017 Roman Gilg
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#include "instancedmaterial.h"
+
+#include <Qt3DRender/QEffect>
+#include <Qt3DRender/QFilterKey>
+#include <Qt3DRender/QGraphicsApiFilter>
+#include <Qt3DRender/QParameter>
+#include <Qt3DRender/QRenderPass>
+#include <Qt3DRender/QShaderProgram>
+#include <Qt3DRender/QTechnique>
+
+#include <QUrl>
+
+InstancedMaterial::InstancedMaterial(const QColor &diffuse, Qt3DCore::QNode *parent)
+    : Qt3DRender::QMaterial(parent)
+{
+    auto effect = new Qt3DRender::QEffect(this);
+
+    // vertex attribute divisors need OpenGL 3.3, llvmpipe offers it as well
+    auto technique = new Qt3DRender::QTechnique(effect);
+    technique->graphicsApiFilter()->setApi(Qt3DRender::QGraphicsApiFilter::OpenGL);
+    technique->graphicsApiFilter()->setProfile(Qt3DRender::QGraphicsApiFilter::NoProfile);
+    technique->graphicsApiFilter()->setMajorVersion(3);
+    technique->graphicsApiFilter()->setMinorVersion(3);
+
+    // picked up by the forward renderer
+    auto filterKey = new Qt3DRender::QFilterKey(technique);
+    filterKey->setName(QStringLiteral("renderingStyle"));
+    filterKey->setValue(QStringLiteral("forward"));
+    technique->addFilterKey(filterKey);
+
+    auto shader = new Qt3DRender::QShaderProgram(technique);
+    shader->setVertexShaderCode(Qt3DRender::QShaderProgram::loadSource(
+                                    QUrl(QStringLiteral("qrc:/view3d/shaders/instanced.vert"))));
+    shader->setFragmentShaderCode(Qt3DRender::QShaderProgram::loadSource(
+                                      QUrl(QStringLiteral("qrc:/view3d/shaders/instanced.frag"))));
+
+    auto pass = new Qt3DRender::QRenderPass(technique);
+    pass->setShaderProgram(shader);
+    technique->addRenderPass(pass);
+    effect->addTechnique(technique);
+
+    addParameter(new Qt3DRender::QParameter(QStringLiteral("ka"), QColor::fromRgbF(0.05, 0.05, 0.05), this));
+    addParameter(new Qt3DRender::QParameter(QStringLiteral("kd"), diffuse, this));
+    addParameter(new Qt3DRender::QParameter(QStringLiteral("ks"), QColor::fromRgbF(0.01, 0.01, 0.01), this));
+    addParameter(new Qt3DRender::QParameter(QStringLiteral("shininess"), 150.0f, this));
+
+    setEffect(effect);
+}
@@ -16,32 +16,20 @@ You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *********************************************************************/
 
-#ifndef EDGE3DENTITY_H
-#define EDGE3DENTITY_H
+#ifndef INSTANCEDMATERIAL_H
+#define INSTANCEDMATERIAL_H
 
-#include <vector>
+#include <Qt3DRender/QMaterial>
 
-#include <Qt3DCore/QEntity>
-#include <Qt3DExtras/QCylinderMesh>
-#include <Qt3DCore/QTransform>
-#include <Qt3DExtras/QPhongMaterial>
+#include <QColor>
 
-class Vertex3DEntity;
-
-class Edge3DEntity : public Qt3DCore::QEntity {
+/*
+ * Phong shading lit from the camera for meshes drawn by Instanced3DEntity.
+ * Every instance is moved by its attributes before the model matrix applies.
+ */
+class InstancedMaterial : public Qt3DRender::QMaterial {
 public:
-    Edge3DEntity(QNode *parent = nullptr);
-    Edge3DEntity(QNode *parent, Vertex3DEntity *v, Vertex3DEntity *w);
-    void init (Vertex3DEntity *v, Vertex3DEntity *w);
-
-    void updateGeometry();
-
-private:
-    Qt3DExtras::QCylinderMesh *m_mesh;
-    Qt3DExtras::QPhongMaterial *m_material;
-    Qt3DCore::QTransform *m_transform;
-
-    Vertex3DEntity *m_v[2];
+    InstancedMaterial(const QColor &diffuse, Qt3DCore::QNode *parent = nullptr);
 };
 
-#endif // EDGE3DENTITY_H
+#endif // INSTANCEDMATERIAL_H
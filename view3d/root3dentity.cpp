@@ -17,16 +17,43 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *********************************************************************/
 
 #include "root3dentity.h"
-#include "vertex3dentity.h"
-#include "edge3dentity.h"
+#include "instanced3dentity.h"
 #include "../gimatrix.h"
+#include "../hypersimplex.h"
 
 #include <QRenderSettings>
 #include <QForwardRenderer>
 #include <QInputSettings>
+#include <QByteArray>
+#include <QVector>
+#include <Qt3DRender/QLevelOfDetailBoundingSphere>
+
+#include <algorithm>
 
 #include "qorbitcameracontroller.h"
 
+static const float s_vertexRadius = 0.04f;
+
+// per level, most detailed first
+struct Tessellation {
+    int sphereRings;
+    int sphereSlices;
+    int cylinderSlices;
+    // projected size of a vertex in pixels from which on the level is used
+    qreal threshold;
+};
+
+static const Tessellation s_tessellations[] = {
+    {24, 24, 20, 48},
+    {16, 16, 14, 24},
+    {10, 12, 10, 12},
+    {6, 8, 6, 0}
+};
+static const int s_levelCount = sizeof(s_tessellations) / sizeof(Tessellation);
+
+// triangles of all instances together, fine for integrated graphics
+static const int s_triangleBudget = 500000;
+
 Root3DEntity::Root3DEntity(QNode *parent)
     : Qt3DCore::QEntity(parent)
 {
@@ -56,6 +83,63 @@ Root3DEntity::Root3DEntity(QNode *parent)
 
     createCoordOrigin();
     createCoordAxes();
+
+    const QColor color(QRgb(0x928327));
+    m_instanceBuffer = new Qt3DRender::QBuffer(Qt3DRender::QBuffer::VertexBuffer, this);
+
+    m_sphere = new Qt3DExtras::QSphereGeometry();
+    m_sphere->setRadius(s_vertexRadius);
+    m_vertices = new Instanced3DEntity(m_sphere, m_instanceBuffer, color, this);
+
+    // unit length along y, stretched per edge; the side needs no rings in between
+    m_cylinder = new Qt3DExtras::QCylinderGeometry();
+    m_cylinder->setRadius(0.02);
+    m_cylinder->setLength(1);
+    m_cylinder->setRings(2);
+    m_edges = new Instanced3DEntity(m_cylinder, m_instanceBuffer, color, this);
+
+    // the renderer measures a vertex at the center of the view every frame
+    QVector<qreal> thresholds;
+    for (auto &t : s_tessellations) {
+        thresholds.append(t.threshold);
+    }
+    m_lod = new Qt3DRender::QLevelOfDetail(this);
+    m_lod->setCamera(camera);
+    m_lod->setThresholdType(Qt3DRender::QLevelOfDetail::ProjectedScreenPixelSizeThreshold);
+    m_lod->setThresholds(thresholds);
+    m_lod->setVolumeOverride(Qt3DRender::QLevelOfDetailBoundingSphere(QVector3D(), s_vertexRadius));
+    addComponent(m_lod);
+
+    connect(m_lod, &Qt3DRender::QLevelOfDetail::currentIndexChanged, this, [this]() {
+        updateTessellation();
+    });
+    updateTessellation();
+}
+
+void Root3DEntity::updateTessellation()
+{
+    // finest level the instance count allows
+    int countLevel = 0;
+    while (countLevel < s_levelCount - 1) {
+        const Tessellation &t = s_tessellations[countLevel];
+        const long triangles = 2L * t.sphereRings * t.sphereSlices * m_vertexCount
+                               + 4L * t.cylinderSlices * m_edgeEnds.size();
+        if (triangles <= s_triangleBudget) {
+            break;
+        }
+        countLevel++;
+    }
+
+    const int level = std::min(std::max(m_lod->currentIndex(), countLevel), s_levelCount - 1);
+    if (level == m_tessellationLevel) {
+        return;
+    }
+    m_tessellationLevel = level;
+
+    const Tessellation &t = s_tessellations[level];
+    m_sphere->setRings(t.sphereRings);
+    m_sphere->setSlices(t.sphereSlices);
+    m_cylinder->setSlices(t.cylinderSlices);
 }
 
 void Root3DEntity::createCoordOrigin()
@@ -65,8 +149,8 @@ void Root3DEntity::createCoordOrigin()
     auto zeroTransform = new Qt3DCore::QTransform(this);
 
     zeroMesh->setRadius(0.03);
-    zeroMesh->setRings(100);
-    zeroMesh->setSlices(20);
+    zeroMesh->setRings(16);
+    zeroMesh->setSlices(16);
     zeroMaterial->setDiffuse(QColor("white"));
 
     addComponent(zeroMesh);
@@ -82,8 +166,8 @@ void Root3DEntity::createCoordAxes()
         auto axeMesh = new Qt3DExtras::QCylinderMesh(this);
         axeMesh->setLength(length);
         axeMesh->setRadius(0.015);
-        axeMesh->setRings(100);
-        axeMesh->setSlices(20);
+        axeMesh->setRings(2);
+        axeMesh->setSlices(12);
 
         auto *axeTransform = new Qt3DCore::QTransform(this);
         if (!rotAxe.isNull()) {
@@ -131,63 +215,80 @@ std::vector<VectorXd> Root3DEntity::getNullspaceRepr(GiMatrix *matrix)
 
 void Root3DEntity::initGeometries(GiMatrix *matrix)
 {
-    clearGeometries();
+    m_vertexCount = matrix->hypersimplex()->vertexCount();
+    m_edgeEnds.clear();
 
-    auto nullSpRepr = getNullspaceRepr(matrix);
-    if (!nullSpRepr.size()) {
-        return;
-    }
-
-
-    for (auto v : nullSpRepr) {
-        Vertex3DEntity *v3d = new Vertex3DEntity(this, v);
-        m_vertices.push_back(v3d);
-    }
-
-    MatrixXd incidences = matrix->getMatrix();
-    for (int row=0; row < incidences.rows(); row++) {
-        for (int col=0; col < row; col++) {
-            if(incidences(row, col) != 0.) {
-                Edge3DEntity *e3d = new Edge3DEntity(this, m_vertices[row], m_vertices[col]);
-                m_edges.push_back(e3d);
-            }
+    const SparseMatrix<double> &incidences = matrix->getMatrix();
+    for (auto edge : matrix->hypersimplex()->adjacency().edges()) {
+        if(incidences.coeff(edge.w, edge.v) != 0.) {
+            m_edgeEnds.push_back(std::make_pair(edge.w, edge.v));
         }
     }
+    m_vertices->setInstanceRange(0, m_vertexCount);
+    m_edges->setInstanceRange(m_vertexCount, m_edgeEnds.size());
+    updateTessellation();
+
+    writeInstances(getNullspaceRepr(matrix));
 }
 
 void Root3DEntity::clearGeometries()
 {
-    for(auto e : m_edges) {
-        delete e;
-        e = nullptr;
-    }
-    m_edges.clear();
+    m_vertexCount = 0;
+    m_edgeEnds.clear();
 
-    for(auto v : m_vertices) {
-        delete v;
-        v = nullptr;
-    }
-    m_vertices.clear();
+    m_vertices->setInstanceRange(0, 0);
+    m_edges->setInstanceRange(0, 0);
+    updateTessellation();
 }
 
 void Root3DEntity::updateGeometries(GiMatrix *matrix)
 {
-    auto nullSpRepr = getNullspaceRepr(matrix);
-    int nullSpReprSize = nullSpRepr.size();
-    if (nullSpReprSize == 0) {
-        clearGeometries();
+    if (matrix->hypersimplex()->vertexCount() != m_vertexCount) {
+        initGeometries(matrix);
         return;
     }
+    writeInstances(getNullspaceRepr(matrix));
+}
 
-    if (nullSpReprSize != m_vertices.size()) {
-        initGeometries(matrix);
+void Root3DEntity::writeInstances(const std::vector<VectorXd> &nullSpRepr)
+{
+    const bool visible = m_vertexCount > 0 && (int)nullSpRepr.size() == m_vertexCount;
+    m_vertices->setEnabled(visible);
+    m_edges->setEnabled(visible && !m_edgeEnds.empty());
+    if (!visible) {
+        return;
     }
 
+    const int floats = Instanced3DEntity::FloatsPerInstance;
+    QByteArray data((m_vertexCount + m_edgeEnds.size()) * floats * sizeof(float), Qt::Uninitialized);
+    float *out = reinterpret_cast<float *>(data.data());
+
+    m_positions.resize(m_vertexCount);
+    for (int i = 0; i < m_vertexCount; i++) {
+        const VectorXd &pos = nullSpRepr[i];
+        QVector3D p;
+        for (int j = 0; j < pos.rows() && j < 3; j++) {
+            p[j] = pos[j];
+        }
+        m_positions[i] = p;
 
-    for (int i = 0; i < nullSpRepr.size(); i++) {
-        m_vertices[i]->updateGeometry(nullSpRepr[i]);
+        Instanced3DEntity::pack(Instanced3DEntity::Instance{p, QQuaternion(), 1.0f}, out);
+        out += floats;
     }
-    for (auto e : m_edges) {
-        e->updateGeometry();
+
+    for (auto &ends : m_edgeEnds) {
+        const QVector3D posV = m_positions[ends.first];
+        const QVector3D dir = m_positions[ends.second] - posV;
+
+        Instanced3DEntity::Instance edge;
+        edge.translation = posV + dir / 2;
+        edge.rotation = QQuaternion::rotationTo(QVector3D(0.0f, 1.0f, 0.0f), dir);
+        edge.length = dir.length();
+
+        Instanced3DEntity::pack(edge, out);
+        out += floats;
     }
+
+    // one change for the whole scene
+    m_instanceBuffer->setData(data);
 }
@@ -23,19 +23,23 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <Qt3DRender/QCamera>
 #include <Qt3DRender/QCameraLens>
 #include <Qt3DCore/QTransform>
+#include <Qt3DRender/QBuffer>
+#include <Qt3DRender/QLevelOfDetail>
 
 #include <Qt3DRender/QRenderAspect>
 #include <Qt3DExtras/QForwardRenderer>
 #include <Qt3DExtras/QPhongMaterial>
 #include <Qt3DExtras/QCylinderMesh>
 #include <Qt3DExtras/QSphereMesh>
+#include <Qt3DExtras/QCylinderGeometry>
+#include <Qt3DExtras/QSphereGeometry>
 
 #include <eigen3/Eigen/Dense>
 
+#include <utility>
 #include <vector>
 
-class Vertex3DEntity;
-class Edge3DEntity;
+class Instanced3DEntity;
 class GiMatrix;
 
 class Root3DEntity : public Qt3DCore::QEntity {
@@ -57,8 +61,25 @@ private:
     void createCoordOrigin();
     void createCoordAxes();
     std::vector<Eigen::VectorXd> getNullspaceRepr(GiMatrix *matrix);
-    std::vector<Vertex3DEntity *> m_vertices;
-    std::vector<Edge3DEntity *> m_edges;
+    // hides the geometries if the representation doesn't fit the topology
+    void writeInstances(const std::vector<Eigen::VectorXd> &nullSpRepr);
+    // from the on-screen size of a vertex and the number of instances
+    void updateTessellation();
+
+    // all vertex spheres respectively all edge cylinders
+    Instanced3DEntity *m_vertices;
+    Instanced3DEntity *m_edges;
+    Qt3DExtras::QSphereGeometry *m_sphere;
+    Qt3DExtras::QCylinderGeometry *m_cylinder;
+    Qt3DRender::QLevelOfDetail *m_lod;
+    int m_tessellationLevel = -1;
+    // instances of the vertices followed by those of the edges
+    Qt3DRender::QBuffer *m_instanceBuffer;
+
+    // topology, fixed until the next initGeometries
+    int m_vertexCount = 0;
+    std::vector<std::pair<int, int> > m_edgeEnds;
+    std::vector<QVector3D> m_positions;
 
     int m_projFacet = 0;
     bool m_projToLargerFacet = true;
@@ -0,0 +1,25 @@
+#version 150
+
+in vec3 eyePosition;
+in vec3 eyeNormal;
+
+uniform vec4 ka;
+uniform vec4 kd;
+uniform vec4 ks;
+uniform float shininess;
+
+out vec4 fragColor;
+
+void main()
+{
+    // the light sits at the camera
+    vec3 n = normalize(eyeNormal);
+    vec3 s = normalize(-eyePosition);
+
+    float diffuse = max(dot(s, n), 0.0);
+    float specular = 0.0;
+    if (diffuse > 0.0) {
+        specular = pow(max(dot(reflect(-s, n), s), 0.0), shininess);
+    }
+    fragColor = vec4(ka.rgb + kd.rgb * diffuse + ks.rgb * specular, 1.0);
+}
@@ -0,0 +1,32 @@
+#version 150
+
+in vec3 vertexPosition;
+in vec3 vertexNormal;
+
+// per instance, the mesh is stretched along y by the length
+in vec3 instanceTranslation;
+in vec4 instanceRotation;
+in float instanceLength;
+
+out vec3 eyePosition;
+out vec3 eyeNormal;
+
+uniform mat4 modelView;
+uniform mat3 modelViewNormal;
+uniform mat4 mvp;
+
+// by the unit quaternion q, its scalar part in w
+vec3 rotate(vec4 q, vec3 v)
+{
+    return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
+
+void main()
+{
+    vec3 position = rotate(instanceRotation, vertexPosition * vec3(1.0, instanceLength, 1.0))
+                    + instanceTranslation;
+
+    eyePosition = vec3(modelView * vec4(position, 1.0));
+    eyeNormal = normalize(modelViewNormal * rotate(instanceRotation, vertexNormal));
+    gl_Position = mvp * vec4(position, 1.0);
+}